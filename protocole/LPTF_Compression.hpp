@@ -0,0 +1,46 @@
+#ifndef LPTF_COMPRESSION_HPP
+#define LPTF_COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LPTF {
+
+// Compression des trames (flag COMPRESSED). Le payload d'une trame compressée est
+//   [u32 taille du payload d'origine][bloc LZ]
+// et le header garde le type du message ; payload_length est celui de la trame
+// compressée. Le bloc LZ suit le principe de LZ4 : séquences [jeton][littéraux]
+// [distance u16][longueur], correspondances d'au moins 4 octets dans une fenêtre
+// de 64 Ko, la dernière séquence ne contenant que des littéraux.
+//
+// La compression se négocie par CAPABILITY_EXCHANGE (champ "compression", masque
+// des codecs) : un pair n'envoie de trame compressée qu'à qui l'a accepté.
+class Compression {
+public:
+    static constexpr uint32_t CODEC_LZ = 0x01;
+    // Payload en dessous duquel la compression n'est pas tentée
+    static constexpr size_t DEFAULT_THRESHOLD = 256;
+    // Refus des trames qui se décompresseraient au-delà (bombe de décompression)
+    static constexpr size_t MAX_DECOMPRESSED_SIZE = 16 * 1024 * 1024;
+
+    // Compresse size octets dans dst ; 0 si le résultat dépasse capacity
+    static size_t compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+    // Décompresse un bloc complet de exactement expected octets ; false si le bloc est invalide
+    static bool decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t expected);
+    // Taille maximale d'un bloc compressé (données incompressibles)
+    static size_t max_compressed_size(size_t size);
+
+    // Ajoute à out la trame compressée si son payload atteint threshold et que la
+    // compression fait gagner de la place ; sinon out est inchangé et false est retourné
+    static bool compress_frame(const uint8_t* frame, size_t size, std::vector<uint8_t>& out,
+                               size_t threshold = DEFAULT_THRESHOLD);
+    // Ajoute à out la trame d'origine (flag COMPRESSED retiré) ; false si la trame
+    // n'est pas compressée ou si son contenu est invalide
+    static bool decompress_frame(const uint8_t* frame, size_t size, std::vector<uint8_t>& out);
+    static bool is_compressed(const uint8_t* frame, size_t size);
+};
+
+} // namespace LPTF
+
+#endif // LPTF_COMPRESSION_HPP
@@ -0,0 +1,71 @@
+#ifndef LPTF_DISPATCH_HPP
+#define LPTF_DISPATCH_HPP
+
+#include "LPTF_Protocol.hpp"
+#include <array>
+#include <cstdint>
+
+namespace LPTF {
+
+// Table de saut MessageType -> gestionnaire. Les types applicatifs
+// (0x0000-0x00EF) sont indexés directement, les messages système (0xFFF0-0xFFFF)
+// occupent les 16 dernières entrées : une recherche est un simple accès au tableau.
+template<typename Handler>
+class DispatchTable {
+public:
+    static constexpr size_t TABLE_SIZE = 256;
+    static constexpr uint16_t SYSTEM_BASE = 0xFFF0;
+    static constexpr size_t SYSTEM_SLOT = TABLE_SIZE - 16;
+
+private:
+    std::array<Handler, TABLE_SIZE> handlers_;
+
+public:
+    // Forme canonique de Coplien
+    DispatchTable() { clear(); }
+    DispatchTable(const DispatchTable& other) = default;
+    DispatchTable& operator=(const DispatchTable& other) = default;
+    ~DispatchTable() = default;
+
+    // -1 si le type ne peut pas figurer dans la table
+    static constexpr int index_of(uint16_t type) {
+        if (type < SYSTEM_SLOT) {
+            return type;
+        }
+        if (type >= SYSTEM_BASE) {
+            return static_cast<int>(SYSTEM_SLOT + (type - SYSTEM_BASE));
+        }
+        return -1;
+    }
+
+    bool set(MessageType type, Handler handler) {
+        const int index = index_of(static_cast<uint16_t>(type));
+        if (index < 0) {
+            return false;
+        }
+        handlers_[index] = handler;
+        return true;
+    }
+
+    void remove(MessageType type) {
+        set(type, Handler());
+    }
+
+    // Gestionnaire nul si le type est inconnu
+    Handler find(MessageType type) const {
+        const int index = index_of(static_cast<uint16_t>(type));
+        return index < 0 ? Handler() : handlers_[index];
+    }
+
+    bool contains(MessageType type) const {
+        return find(type) != Handler();
+    }
+
+    void clear() {
+        handlers_.fill(Handler());
+    }
+};
+
+} // namespace LPTF
+
+#endif // LPTF_DISPATCH_HPP
@@ -0,0 +1,202 @@
+#include "LPTF_Fragment.hpp"
+#include <cstring>
+
+namespace LPTF {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = LPTF_PacketView::HEADER_SIZE;
+// Au-delà, un tampon de flux abandonné ou terminé est libéré plutôt que conservé
+constexpr size_t RETAINED_CAPACITY = 1024 * 1024;
+
+uint32_t read_u32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, 4);
+    return ByteOrder::ntoh32(value);
+}
+
+void write_u32(uint32_t value, uint8_t* out) {
+    const uint32_t net = ByteOrder::hton32(value);
+    std::memcpy(out, &net, 4);
+}
+
+} // namespace
+
+size_t Fragmentation::split_frame(const uint8_t* frame, size_t size, uint32_t stream_id, std::vector<uint8_t>& out,
+                                  size_t fragment_size) {
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    if (fragment_size == 0) {
+        fragment_size = DEFAULT_FRAGMENT_SIZE;
+    }
+    const size_t payload = size - HEADER_SIZE;
+    const size_t count = payload == 0 ? 1 : (payload + fragment_size - 1) / fragment_size;
+
+    const size_t start = out.size();
+    out.resize(start + count * (HEADER_SIZE + FRAGMENT_HEADER_SIZE) + payload);
+    uint8_t* target = out.data() + start;
+    size_t position = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t chunk = payload - position < fragment_size ? payload - position : fragment_size;
+        std::memcpy(target, frame, HEADER_SIZE);
+        target[5] |= static_cast<uint8_t>(PacketFlags::FRAGMENTED);
+        write_u32(static_cast<uint32_t>(FRAGMENT_HEADER_SIZE + chunk), target + 8);
+        write_u32(stream_id, target + HEADER_SIZE);
+        write_u32(static_cast<uint32_t>(payload), target + HEADER_SIZE + 4);
+        write_u32(static_cast<uint32_t>(position), target + HEADER_SIZE + 8);
+        if (chunk > 0) {
+            std::memcpy(target + HEADER_SIZE + FRAGMENT_HEADER_SIZE, frame + HEADER_SIZE + position, chunk);
+        }
+        target += HEADER_SIZE + FRAGMENT_HEADER_SIZE + chunk;
+        position += chunk;
+    }
+    return count;
+}
+
+bool Fragmentation::split_frames(const uint8_t* frames, size_t size, uint32_t& next_stream_id,
+                                 std::vector<uint8_t>& out, size_t threshold, size_t fragment_size) {
+    const size_t start = out.size();
+    size_t copied = 0; // Octets de frames déjà reportés dans out
+    bool split = false;
+    size_t offset = 0;
+    while (size - offset >= HEADER_SIZE) {
+        const size_t frame_size = HEADER_SIZE + read_u32(frames + offset + 8);
+        if (frame_size > size - offset) {
+            break;
+        }
+        if (frame_size > threshold && !is_fragment(frames + offset, frame_size)) {
+            out.insert(out.end(), frames + copied, frames + offset);
+            split_frame(frames + offset, frame_size, next_stream_id++, out, fragment_size);
+            copied = offset + frame_size;
+            split = true;
+        }
+        offset += frame_size;
+    }
+
+    if (!split) {
+        out.resize(start);
+        return false;
+    }
+    out.insert(out.end(), frames + copied, frames + size);
+    return true;
+}
+
+bool Fragmentation::is_fragment(const uint8_t* frame, size_t size) {
+    return size >= HEADER_SIZE && (frame[5] & static_cast<uint8_t>(PacketFlags::FRAGMENTED)) != 0;
+}
+
+FragmentReassembler::FragmentReassembler(size_t max_streams, size_t max_message_size, size_t max_buffered)
+    : streams_(max_streams == 0 ? 1 : max_streams), max_message_size_(max_message_size),
+      max_buffered_(max_buffered), buffered_(0), active_(0) {
+    for (Stream& stream : streams_) {
+        stream.id = 0;
+        stream.total = 0;
+        stream.active = false;
+    }
+}
+
+FragmentStatus FragmentReassembler::add(const uint8_t* fragment, size_t size, ByteSpan& message) {
+    if (!Fragmentation::is_fragment(fragment, size) || size < HEADER_SIZE + Fragmentation::FRAGMENT_HEADER_SIZE ||
+        read_u32(fragment + 8) != size - HEADER_SIZE) {
+        return FragmentStatus::INVALID;
+    }
+    // Le message précédent n'est plus référencé : un gros tampon n'est pas gardé au repos
+    if (complete_.capacity() > RETAINED_CAPACITY) {
+        std::vector<uint8_t>().swap(complete_);
+    }
+    const uint8_t* payload = fragment + HEADER_SIZE;
+    const uint32_t id = read_u32(payload);
+    const uint32_t total = read_u32(payload + 4);
+    const uint32_t position = read_u32(payload + 8);
+    const size_t chunk = size - HEADER_SIZE - Fragmentation::FRAGMENT_HEADER_SIZE;
+
+    Stream* stream = find_stream(id);
+    if (!stream) {
+        if (position != 0) {
+            return FragmentStatus::INVALID;
+        }
+        if (total > max_message_size_ || active_ == streams_.size()) {
+            return FragmentStatus::LIMIT;
+        }
+        for (Stream& candidate : streams_) {
+            if (!candidate.active) {
+                stream = &candidate;
+                break;
+            }
+        }
+        stream->id = id;
+        stream->total = total;
+        stream->active = true;
+        stream->frame.assign(fragment, fragment + HEADER_SIZE);
+        stream->frame[5] &= static_cast<uint8_t>(~static_cast<uint8_t>(PacketFlags::FRAGMENTED));
+        write_u32(total, stream->frame.data() + 8);
+        ++active_;
+    }
+
+    // Les fragments d'un flux sont contigus et ne dépassent pas la taille annoncée
+    const size_t received = stream->frame.size() - HEADER_SIZE;
+    if (total != stream->total || position != received || chunk > total - received) {
+        drop_stream(*stream);
+        return FragmentStatus::INVALID;
+    }
+    if (chunk > max_buffered_ - buffered_) {
+        drop_stream(*stream);
+        return FragmentStatus::LIMIT;
+    }
+
+    stream->frame.insert(stream->frame.end(), payload + Fragmentation::FRAGMENT_HEADER_SIZE, fragment + size);
+    buffered_ += chunk;
+    if (received + chunk < total) {
+        return FragmentStatus::INCOMPLETE;
+    }
+
+    // Le tampon du flux et celui du message précédent sont échangés : aucune copie
+    buffered_ -= total;
+    complete_.swap(stream->frame);
+    stream->frame.clear();
+    drop_stream(*stream);
+    message = ByteSpan(complete_.data(), complete_.size());
+    return FragmentStatus::COMPLETE;
+}
+
+size_t FragmentReassembler::get_active_streams() const {
+    return active_;
+}
+
+size_t FragmentReassembler::get_buffered_bytes() const {
+    return buffered_;
+}
+
+void FragmentReassembler::clear() {
+    for (Stream& stream : streams_) {
+        if (stream.active) {
+            drop_stream(stream);
+        }
+    }
+    complete_.clear();
+    if (complete_.capacity() > RETAINED_CAPACITY) {
+        std::vector<uint8_t>().swap(complete_);
+    }
+}
+
+FragmentReassembler::Stream* FragmentReassembler::find_stream(uint32_t id) {
+    for (Stream& stream : streams_) {
+        if (stream.active && stream.id == id) {
+            return &stream;
+        }
+    }
+    return nullptr;
+}
+
+void FragmentReassembler::drop_stream(Stream& stream) {
+    buffered_ -= stream.frame.size() >= HEADER_SIZE ? stream.frame.size() - HEADER_SIZE : 0;
+    stream.active = false;
+    stream.frame.clear();
+    if (stream.frame.capacity() > RETAINED_CAPACITY) {
+        std::vector<uint8_t>().swap(stream.frame);
+    }
+    --active_;
+}
+
+} // namespace LPTF
@@ -0,0 +1,95 @@
+#ifndef LPTF_FRAGMENT_HPP
+#define LPTF_FRAGMENT_HPP
+
+#include "LPTF_PacketView.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace LPTF {
+
+// Fragmentation des messages volumineux (flag FRAGMENTED). Chaque fragment est
+// une trame complète qui garde le type et les autres flags du message ; son
+// payload est
+//   [u32 flux][u32 taille totale du payload][u32 position][morceau]
+// Les fragments d'un même flux arrivent dans l'ordre, mais ceux de flux
+// différents et les trames ordinaires peuvent s'intercaler librement.
+class Fragmentation {
+public:
+    static constexpr size_t FRAGMENT_HEADER_SIZE = 12;
+    // Octets de payload d'origine par fragment
+    static constexpr size_t DEFAULT_FRAGMENT_SIZE = 16 * 1024;
+    // Trame (header compris) au-delà de laquelle un message est fragmenté
+    static constexpr size_t DEFAULT_THRESHOLD = 64 * 1024;
+
+    // Ajoute à out les fragments de la trame ; retourne leur nombre
+    static size_t split_frame(const uint8_t* frame, size_t size, uint32_t stream_id, std::vector<uint8_t>& out,
+                              size_t fragment_size = DEFAULT_FRAGMENT_SIZE);
+    // Recopie une suite de trames dans out en fragmentant celles qui dépassent
+    // threshold (un flux chacune, numérotés à partir de next_stream_id) ;
+    // retourne false, out inchangé, si aucune ne le dépasse
+    static bool split_frames(const uint8_t* frames, size_t size, uint32_t& next_stream_id, std::vector<uint8_t>& out,
+                             size_t threshold = DEFAULT_THRESHOLD, size_t fragment_size = DEFAULT_FRAGMENT_SIZE);
+    static bool is_fragment(const uint8_t* frame, size_t size);
+};
+
+enum class FragmentStatus {
+    INCOMPLETE, // Fragment accepté, message pas encore complet
+    COMPLETE,   // Message reconstitué
+    INVALID,    // Fragment incohérent : le flux est abandonné
+    LIMIT       // Limite de flux ou de mémoire dépassée : le flux est abandonné
+};
+
+// Réassemblage des messages fragmentés d'une connexion, à mémoire bornée :
+// au plus max_streams flux ouverts, max_message_size octets par message et
+// max_buffered octets en attente tous flux confondus. Les tampons ne grandissent
+// qu'au fil des fragments reçus, jamais d'après la taille annoncée.
+class FragmentReassembler {
+public:
+    static constexpr size_t DEFAULT_MAX_STREAMS = 8;
+    static constexpr size_t DEFAULT_MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_BUFFERED = 32 * 1024 * 1024;
+
+private:
+    struct Stream {
+        uint32_t id;
+        uint32_t total;
+        bool active;
+        std::vector<uint8_t> frame; // Header du message puis payload reçu
+    };
+
+    std::vector<Stream> streams_;
+    std::vector<uint8_t> complete_; // Dernier message reconstitué
+    size_t max_message_size_;
+    size_t max_buffered_;
+    size_t buffered_;
+    size_t active_;
+
+public:
+    // Forme canonique de Coplien
+    explicit FragmentReassembler(size_t max_streams = DEFAULT_MAX_STREAMS,
+                                 size_t max_message_size = DEFAULT_MAX_MESSAGE_SIZE,
+                                 size_t max_buffered = DEFAULT_MAX_BUFFERED);
+    FragmentReassembler(const FragmentReassembler& other) = default;
+    FragmentReassembler& operator=(const FragmentReassembler& other) = default;
+    ~FragmentReassembler() = default;
+
+    FragmentReassembler(FragmentReassembler&& other) noexcept = default;
+    FragmentReassembler& operator=(FragmentReassembler&& other) noexcept = default;
+
+    // Intègre un fragment. Sur COMPLETE, message désigne la trame reconstituée
+    // (flag FRAGMENTED retiré), valide jusqu'au prochain appel à add() ou clear()
+    FragmentStatus add(const uint8_t* fragment, size_t size, ByteSpan& message);
+
+    size_t get_active_streams() const;
+    size_t get_buffered_bytes() const;
+    void clear();
+
+private:
+    Stream* find_stream(uint32_t id);
+    void drop_stream(Stream& stream);
+};
+
+} // namespace LPTF
+
+#endif // LPTF_FRAGMENT_HPP
@@ -0,0 +1,144 @@
+#include "LPTF_Framing.hpp"
+#include "LPTF_Protocol.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace LPTF {
+
+FrameReassembler::FrameReassembler(size_t max_frame_size)
+    : read_pos_(0), write_pos_(0), max_frame_size_(max_frame_size), corrupted_(false) {
+}
+
+uint8_t* FrameReassembler::prepare(size_t min_size) {
+    if (buffer_.size() - write_pos_ < min_size) {
+        compact();
+    }
+    if (buffer_.size() - write_pos_ < min_size) {
+        size_t new_size = buffer_.empty() ? 4096 : buffer_.size() * 2;
+        while (new_size - write_pos_ < min_size) {
+            new_size *= 2;
+        }
+        buffer_.resize(new_size);
+    }
+    return buffer_.data() + write_pos_;
+}
+
+size_t FrameReassembler::writable_size() const {
+    return buffer_.size() - write_pos_;
+}
+
+void FrameReassembler::commit(size_t bytes) {
+    write_pos_ += std::min(bytes, writable_size());
+}
+
+void FrameReassembler::append(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    std::memcpy(prepare(size), data, size);
+    commit(size);
+}
+
+size_t FrameReassembler::peek_frame_size(const uint8_t* data, size_t size) {
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data, 4);
+    if (ByteOrder::ntoh32(magic) != 0x4C505446) {
+        return 0;
+    }
+    uint32_t payload_length;
+    std::memcpy(&payload_length, data + 8, 4);
+    return HEADER_SIZE + ByteOrder::ntoh32(payload_length);
+}
+
+bool FrameReassembler::next_frame(const uint8_t*& frame, size_t& frame_size) {
+    if (corrupted_) {
+        return false;
+    }
+
+    const size_t available = write_pos_ - read_pos_;
+    if (available < HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* start = buffer_.data() + read_pos_;
+    const size_t total = peek_frame_size(start, available);
+    if (total == 0 || total > max_frame_size_) {
+        corrupted_ = true;
+        return false;
+    }
+    if (available < total) {
+        return false;
+    }
+
+    frame = start;
+    frame_size = total;
+    read_pos_ += total;
+    if (read_pos_ == write_pos_) {
+        // Tampon vide : la prochaine lecture repart du début sans memmove.
+        // La trame retournée reste lisible car les octets ne sont pas écrasés avant prepare().
+        read_pos_ = 0;
+        write_pos_ = 0;
+    }
+    return true;
+}
+
+bool FrameReassembler::next_frame(std::vector<uint8_t>& frame) {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!next_frame(data, size)) {
+        return false;
+    }
+    frame.assign(data, data + size);
+    return true;
+}
+
+const uint8_t* FrameReassembler::peek_data() const {
+    return buffer_.data() + read_pos_;
+}
+
+void FrameReassembler::consume(size_t bytes) {
+    read_pos_ += std::min(bytes, buffered_size());
+    if (read_pos_ == write_pos_) {
+        read_pos_ = 0;
+        write_pos_ = 0;
+    }
+}
+
+bool FrameReassembler::is_corrupted() const {
+    return corrupted_;
+}
+
+size_t FrameReassembler::buffered_size() const {
+    return write_pos_ - read_pos_;
+}
+
+size_t FrameReassembler::get_max_frame_size() const {
+    return max_frame_size_;
+}
+
+void FrameReassembler::set_max_frame_size(size_t max_frame_size) {
+    max_frame_size_ = max_frame_size;
+}
+
+void FrameReassembler::clear() {
+    read_pos_ = 0;
+    write_pos_ = 0;
+    corrupted_ = false;
+}
+
+void FrameReassembler::compact() {
+    if (read_pos_ == 0) {
+        return;
+    }
+    const size_t remaining = write_pos_ - read_pos_;
+    if (remaining > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + read_pos_, remaining);
+    }
+    read_pos_ = 0;
+    write_pos_ = remaining;
+}
+
+} // namespace LPTF
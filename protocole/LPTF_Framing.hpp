@@ -0,0 +1,66 @@
+#ifndef LPTF_FRAMING_HPP
+#define LPTF_FRAMING_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace LPTF {
+
+// Réassemblage des trames LPTF sur un flux TCP.
+// Les octets reçus sont accumulés dans un tampon persistant ; une trame est
+// complète dès que 12 octets de header + payload_length sont disponibles.
+// Un même appel à recv peut donc produire zéro, une ou plusieurs trames.
+class FrameReassembler {
+private:
+    std::vector<uint8_t> buffer_;
+    size_t read_pos_;   // Début des octets non consommés
+    size_t write_pos_;  // Fin des octets reçus
+    size_t max_frame_size_;
+    bool corrupted_;
+
+public:
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t DEFAULT_MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+    // Forme canonique de Coplien
+    explicit FrameReassembler(size_t max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+    FrameReassembler(const FrameReassembler& other) = default;
+    FrameReassembler& operator=(const FrameReassembler& other) = default;
+    ~FrameReassembler() = default;
+
+    FrameReassembler(FrameReassembler&& other) noexcept = default;
+    FrameReassembler& operator=(FrameReassembler&& other) noexcept = default;
+
+    // Zone d'écriture directe pour recv() : évite une copie intermédiaire
+    uint8_t* prepare(size_t min_size);
+    size_t writable_size() const;
+    void commit(size_t bytes);
+    void append(const uint8_t* data, size_t size);
+
+    // Extrait la prochaine trame complète. Le pointeur retourné reste valide
+    // jusqu'au prochain appel à prepare(), append() ou clear().
+    bool next_frame(const uint8_t*& frame, size_t& frame_size);
+    bool next_frame(std::vector<uint8_t>& frame);
+
+    // Accès brut aux octets non consommés (flux non LPTF, ex. mode texte)
+    const uint8_t* peek_data() const;
+    void consume(size_t bytes);
+
+    // Magic invalide ou trame plus grande que max_frame_size : le flux est inexploitable
+    bool is_corrupted() const;
+    size_t buffered_size() const;
+    size_t get_max_frame_size() const;
+    void set_max_frame_size(size_t max_frame_size);
+    void clear();
+
+    // Taille totale (header compris) annoncée par un header, 0 si magic invalide
+    static size_t peek_frame_size(const uint8_t* data, size_t size);
+
+private:
+    void compact();
+};
+
+} // namespace LPTF
+
+#endif // LPTF_FRAMING_HPP
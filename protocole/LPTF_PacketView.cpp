@@ -0,0 +1,196 @@
+#include "LPTF_PacketView.hpp"
+#include <cstring>
+
+namespace LPTF {
+
+LPTF_PacketView::LPTF_PacketView()
+    : data_(nullptr), size_(0), version_(0), flags_(0), message_type_(0),
+      payload_length_(0), field_count_(0), valid_(false) {
+}
+
+LPTF_PacketView::LPTF_PacketView(const uint8_t* data, size_t size) : LPTF_PacketView() {
+    parse(data, size);
+}
+
+bool LPTF_PacketView::parse(const uint8_t* data, size_t size) {
+    data_ = data;
+    size_ = size;
+    field_count_ = 0;
+    valid_ = false;
+
+    if (!data || size < HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t magic;
+    std::memcpy(&magic, data, 4);
+    if (ByteOrder::ntoh32(magic) != 0x4C505446) {
+        return false;
+    }
+
+    version_ = data[4];
+    if (!LPTF_Packet::is_compatible_version(version_)) {
+        return false;
+    }
+    flags_ = data[5];
+    // Le payload d'une trame compressée ou d'un fragment n'est pas une table de
+    // champs : Compression::decompress_frame ou FragmentReassembler d'abord
+    if (flags_ & (static_cast<uint8_t>(PacketFlags::COMPRESSED) | static_cast<uint8_t>(PacketFlags::FRAGMENTED))) {
+        return false;
+    }
+
+    std::memcpy(&message_type_, data + 6, 2);
+    message_type_ = ByteOrder::ntoh16(message_type_);
+
+    std::memcpy(&payload_length_, data + 8, 4);
+    payload_length_ = ByteOrder::ntoh32(payload_length_);
+
+    if (size - HEADER_SIZE < payload_length_) {
+        return false;
+    }
+
+    // Validation de la table des champs : les accesseurs peuvent ensuite la relire sans contrôle d'erreur
+    size_t offset = HEADER_SIZE;
+    const size_t end = HEADER_SIZE + payload_length_;
+    FieldView field;
+    while (offset < end) {
+        if (!read_field(offset, end, field)) {
+            return false;
+        }
+        switch (field.type) {
+            case DataType::STRING:
+            case DataType::BINARY:
+                break;
+            case DataType::UINT32:
+                if (field.value.size != 4) return false;
+                break;
+            case DataType::UINT64:
+                if (field.value.size != 8) return false;
+                break;
+            default:
+                return false; // Même restriction que LPTF_Packet::deserialize
+        }
+        ++field_count_;
+    }
+
+    size_ = end;
+    valid_ = true;
+    return true;
+}
+
+bool LPTF_PacketView::read_field(size_t& offset, size_t end, FieldView& field) const {
+    if (offset + 1 > end) return false;
+    const uint8_t name_len = data_[offset++];
+
+    if (offset + name_len > end) return false;
+    field.name = std::string_view(reinterpret_cast<const char*>(data_ + offset), name_len);
+    offset += name_len;
+
+    if (offset + 1 > end) return false;
+    field.type = static_cast<DataType>(data_[offset++]);
+
+    size_t data_len = 0;
+    if (!FieldLength::read(data_, end, offset, data_len)) return false;
+
+    if (data_len > end - offset) return false;
+    field.value = ByteSpan(data_ + offset, data_len);
+    offset += data_len;
+    return true;
+}
+
+bool LPTF_PacketView::is_valid() const {
+    return valid_;
+}
+
+MessageType LPTF_PacketView::get_message_type() const {
+    return static_cast<MessageType>(message_type_);
+}
+
+uint8_t LPTF_PacketView::get_version() const {
+    return version_;
+}
+
+uint8_t LPTF_PacketView::get_flags() const {
+    return flags_;
+}
+
+uint32_t LPTF_PacketView::get_payload_length() const {
+    return payload_length_;
+}
+
+bool LPTF_PacketView::has_flag(PacketFlags flag) const {
+    return (flags_ & static_cast<uint8_t>(flag)) != 0;
+}
+
+ByteSpan LPTF_PacketView::get_frame() const {
+    return valid_ ? ByteSpan(data_, size_) : ByteSpan();
+}
+
+size_t LPTF_PacketView::get_field_count() const {
+    return field_count_;
+}
+
+bool LPTF_PacketView::find_field(std::string_view name, FieldView& field) const {
+    bool found = false;
+    for_each_field([&](const FieldView& current) {
+        if (current.name == name) {
+            field = current;
+            found = true;
+            return false;
+        }
+        return true;
+    });
+    return found;
+}
+
+bool LPTF_PacketView::has_field(std::string_view name) const {
+    FieldView field;
+    return find_field(name, field);
+}
+
+bool LPTF_PacketView::get_string(std::string_view name, std::string_view& value) const {
+    FieldView field;
+    if (!find_field(name, field) || field.type != DataType::STRING) {
+        return false;
+    }
+    value = std::string_view(reinterpret_cast<const char*>(field.value.data), field.value.size);
+    return true;
+}
+
+bool LPTF_PacketView::get_binary(std::string_view name, ByteSpan& value) const {
+    FieldView field;
+    if (!find_field(name, field) || field.type != DataType::BINARY) {
+        return false;
+    }
+    value = field.value;
+    return true;
+}
+
+bool LPTF_PacketView::get_uint32(std::string_view name, uint32_t& value) const {
+    FieldView field;
+    if (!find_field(name, field) || field.type != DataType::UINT32) {
+        return false;
+    }
+    std::memcpy(&value, field.value.data, 4);
+    value = ByteOrder::ntoh32(value);
+    return true;
+}
+
+bool LPTF_PacketView::get_uint64(std::string_view name, uint64_t& value) const {
+    FieldView field;
+    if (!find_field(name, field) || field.type != DataType::UINT64) {
+        return false;
+    }
+    std::memcpy(&value, field.value.data, 8);
+    value = ByteOrder::ntoh64(value);
+    return true;
+}
+
+bool LPTF_PacketView::to_packet(LPTF_Packet& packet) const {
+    if (!valid_) {
+        return false;
+    }
+    return packet.deserialize(data_, size_);
+}
+
+} // namespace LPTF
@@ -0,0 +1,99 @@
+#ifndef LPTF_PACKET_VIEW_HPP
+#define LPTF_PACKET_VIEW_HPP
+
+#include "LPTF_Protocol.hpp"
+#include <string_view>
+#include <cstddef>
+
+namespace LPTF {
+
+// Plage d'octets empruntée (non possédée)
+struct ByteSpan {
+    const uint8_t* data;
+    size_t size;
+
+    ByteSpan() : data(nullptr), size(0) {}
+    ByteSpan(const uint8_t* d, size_t s) : data(d), size(s) {}
+};
+
+// Champ tel qu'il apparaît dans la trame : nom, type et valeur brute (ordre réseau)
+struct FieldView {
+    std::string_view name;
+    DataType type;
+    ByteSpan value;
+};
+
+// Vue en lecture seule sur une trame LPTF sérialisée.
+// Le header et la table des champs sont validés sur place, sans aucune
+// allocation ; les accesseurs retournent des string_view / ByteSpan qui
+// pointent dans le tampon emprunté, qui doit donc survivre à la vue.
+class LPTF_PacketView {
+private:
+    const uint8_t* data_;
+    size_t size_;
+    uint8_t version_;
+    uint8_t flags_;
+    uint16_t message_type_;
+    uint32_t payload_length_;
+    size_t field_count_;
+    bool valid_;
+
+public:
+    // Forme canonique de Coplien
+    LPTF_PacketView();
+    LPTF_PacketView(const uint8_t* data, size_t size);
+    LPTF_PacketView(const LPTF_PacketView& other) = default;
+    LPTF_PacketView& operator=(const LPTF_PacketView& other) = default;
+    ~LPTF_PacketView() = default;
+
+    // Valide le header puis la table des champs ; false si la trame est invalide
+    bool parse(const uint8_t* data, size_t size);
+    bool is_valid() const;
+
+    // Header
+    MessageType get_message_type() const;
+    uint8_t get_version() const;
+    uint8_t get_flags() const;
+    uint32_t get_payload_length() const;
+    bool has_flag(PacketFlags flag) const;
+
+    // Trame complète (header + payload), utile pour relayer sans resérialiser
+    ByteSpan get_frame() const;
+    size_t get_field_count() const;
+
+    // Accès aux champs par nom : parcours linéaire de la table validée
+    bool find_field(std::string_view name, FieldView& field) const;
+    bool has_field(std::string_view name) const;
+    bool get_string(std::string_view name, std::string_view& value) const;
+    bool get_binary(std::string_view name, ByteSpan& value) const;
+    bool get_uint32(std::string_view name, uint32_t& value) const;
+    bool get_uint64(std::string_view name, uint64_t& value) const;
+
+    // Parcours des champs dans l'ordre de la trame ; fn retourne false pour s'arrêter
+    template<typename Fn>
+    void for_each_field(Fn&& fn) const {
+        if (!valid_) {
+            return;
+        }
+        size_t offset = HEADER_SIZE;
+        const size_t end = HEADER_SIZE + payload_length_;
+        FieldView field;
+        while (offset < end && read_field(offset, end, field)) {
+            if (!fn(field)) {
+                return;
+            }
+        }
+    }
+
+    // Conversion explicite vers un paquet complet (alloue)
+    bool to_packet(LPTF_Packet& packet) const;
+
+    static constexpr size_t HEADER_SIZE = 12;
+
+private:
+    bool read_field(size_t& offset, size_t end, FieldView& field) const;
+};
+
+} // namespace LPTF
+
+#endif // LPTF_PACKET_VIEW_HPP
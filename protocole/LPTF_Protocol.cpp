@@ -1,4 +1,6 @@
 #include "LPTF_Protocol.hpp"
+#include "LPTF_Compression.hpp"
+#include "LPTF_Schema.hpp"
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
@@ -43,7 +45,186 @@ uint32_t ByteOrder::ntoh32(uint32_t value) { return hton32(value); }
 uint64_t ByteOrder::ntoh64(uint64_t value) { return hton64(value); }
 
 
-LPTF_Packet::LPTF_Packet() {
+size_t FieldLength::write(size_t length, uint8_t* out) {
+    if (length < EXTENDED) {
+        const uint16_t net = ByteOrder::hton16(static_cast<uint16_t>(length));
+        std::memcpy(out, &net, 2);
+        return 2;
+    }
+    const uint16_t escape = ByteOrder::hton16(EXTENDED);
+    const uint32_t net = ByteOrder::hton32(static_cast<uint32_t>(length));
+    std::memcpy(out, &escape, 2);
+    std::memcpy(out + 2, &net, 4);
+    return 6;
+}
+
+bool FieldLength::read(const uint8_t* data, size_t end, size_t& offset, size_t& length) {
+    if (offset + 2 > end) return false;
+    uint16_t short_length;
+    std::memcpy(&short_length, data + offset, 2);
+    short_length = ByteOrder::ntoh16(short_length);
+    offset += 2;
+    if (short_length != EXTENDED) {
+        length = short_length;
+        return true;
+    }
+    if (offset + 4 > end) return false;
+    uint32_t long_length;
+    std::memcpy(&long_length, data + offset, 4);
+    length = ByteOrder::ntoh32(long_length);
+    offset += 4;
+    return true;
+}
+
+FieldName::FieldName() : size_(0), inline_(), heap_(nullptr) {
+}
+
+FieldName::FieldName(std::string_view name) : size_(0), inline_(), heap_(nullptr) {
+    assign(name);
+}
+
+FieldName::FieldName(const FieldName& other) : size_(0), inline_(), heap_(nullptr) {
+    assign(other.view());
+}
+
+FieldName& FieldName::operator=(const FieldName& other) {
+    if (this != &other) {
+        assign(other.view());
+    }
+    return *this;
+}
+
+std::string_view FieldName::view() const {
+    return std::string_view(heap_ ? heap_.get() : inline_, size_);
+}
+
+void FieldName::assign(std::string_view name) {
+    // La longueur du nom est encodée sur un octet
+    if (name.size() > 255) {
+        throw SerializationException("Field name too long: " + std::string(name.substr(0, 32)) + "...");
+    }
+    size_ = static_cast<uint8_t>(name.size());
+    if (name.size() <= INLINE_CAPACITY) {
+        heap_.reset();
+        std::memcpy(inline_, name.data(), name.size());
+    } else {
+        heap_.reset(new char[name.size()]);
+        std::memcpy(heap_.get(), name.data(), name.size());
+    }
+}
+
+
+FieldStore::FieldStore() : size_(0) {
+}
+
+FieldStore::FieldStore(FieldStore&& other) noexcept
+    : inline_(std::move(other.inline_)), heap_(std::move(other.heap_)), size_(other.size_) {
+    other.size_ = 0;
+}
+
+FieldStore& FieldStore::operator=(FieldStore&& other) noexcept {
+    if (this != &other) {
+        inline_ = std::move(other.inline_);
+        heap_ = std::move(other.heap_);
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+FieldStore::Field* FieldStore::data() {
+    return size_ > INLINE_FIELDS ? heap_.data() : inline_.data();
+}
+
+const FieldStore::Field* FieldStore::data() const {
+    return size_ > INLINE_FIELDS ? heap_.data() : inline_.data();
+}
+
+DataValue& FieldStore::operator[](std::string_view name) {
+    Field* fields = data();
+    size_t pos = 0;
+    while (pos < size_) {
+        const int cmp = fields[pos].name.view().compare(name);
+        if (cmp == 0) {
+            return fields[pos].value;
+        }
+        if (cmp > 0) {
+            break;
+        }
+        ++pos;
+    }
+    
+    if (size_ < INLINE_FIELDS) {
+        // Décalage d'un cran dans le tableau en ligne
+        for (size_t i = size_; i > pos; --i) {
+            inline_[i] = std::move(inline_[i - 1]);
+        }
+        inline_[pos].name = FieldName(name);
+        inline_[pos].value = DataValue();
+        ++size_;
+        return inline_[pos].value;
+    }
+    
+    if (size_ == INLINE_FIELDS) {
+        // Bascule sur le tas au 9e champ
+        heap_.clear();
+        heap_.reserve(INLINE_FIELDS * 2);
+        for (Field& field : inline_) {
+            heap_.push_back(std::move(field));
+        }
+    }
+    
+    heap_.insert(heap_.begin() + pos, Field{FieldName(name), DataValue()});
+    ++size_;
+    return heap_[pos].value;
+}
+
+const DataValue* FieldStore::find(std::string_view name) const {
+    const Field* fields = data();
+    for (size_t i = 0; i < size_; ++i) {
+        const int cmp = fields[i].name.view().compare(name);
+        if (cmp == 0) {
+            return &fields[i].value;
+        }
+        if (cmp > 0) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+bool FieldStore::contains(std::string_view name) const {
+    return find(name) != nullptr;
+}
+
+size_t FieldStore::size() const {
+    return size_;
+}
+
+bool FieldStore::empty() const {
+    return size_ == 0;
+}
+
+void FieldStore::clear() {
+    // Les valeurs sont remises à zéro pour libérer les chaînes/tampons
+    const size_t inline_count = size_ < INLINE_FIELDS ? size_ : INLINE_FIELDS;
+    for (size_t i = 0; i < inline_count; ++i) {
+        inline_[i].value = DataValue();
+    }
+    heap_.clear();
+    size_ = 0;
+}
+
+const FieldStore::Field* FieldStore::begin() const {
+    return data();
+}
+
+const FieldStore::Field* FieldStore::end() const {
+    return data() + size_;
+}
+
+
+LPTF_Packet::LPTF_Packet() : compression_threshold_(0) {
     header_.magic = 0x4C505446;
     header_.version = 1;
     header_.flags = 0;
@@ -55,7 +236,7 @@ LPTF_Packet::LPTF_Packet(MessageType type) : LPTF_Packet() {
     header_.message_type = static_cast<uint16_t>(type);
 }
 
-LPTF_Packet::LPTF_Packet(const LPTF_Packet& other) {
+LPTF_Packet::LPTF_Packet(const LPTF_Packet& other) : compression_threshold_(0) {
     copy_from(other);
 }
 
@@ -70,7 +251,7 @@ LPTF_Packet::~LPTF_Packet() {
    
 }
 
-LPTF_Packet::LPTF_Packet(LPTF_Packet&& other) noexcept {
+LPTF_Packet::LPTF_Packet(LPTF_Packet&& other) noexcept : compression_threshold_(0) {
     move_from(std::move(other));
 }
 
@@ -97,6 +278,14 @@ void LPTF_Packet::remove_flag(PacketFlags flag) {
     header_.flags &= ~static_cast<uint8_t>(flag);
 }
 
+void LPTF_Packet::set_compression_threshold(size_t threshold) {
+    compression_threshold_ = threshold;
+}
+
+size_t LPTF_Packet::get_compression_threshold() const {
+    return compression_threshold_;
+}
+
 void LPTF_Packet::set_string(const std::string& name, const std::string& value) {
     fields_[name] = value;
 }
@@ -114,10 +303,10 @@ void LPTF_Packet::set_binary(const std::string& name, const std::vector<uint8_t>
 }
 
 std::string LPTF_Packet::get_string(const std::string& name) const {
-    auto it = fields_.find(name);
-    if (it != fields_.end()) {
+    const DataValue* value = fields_.find(name);
+    if (value) {
         try {
-            return std::get<std::string>(it->second);
+            return std::get<std::string>(*value);
         } catch (const std::bad_variant_access&) {
             throw DeserializationException("Field '" + name + "' is not a string");
         }
@@ -126,10 +315,10 @@ std::string LPTF_Packet::get_string(const std::string& name) const {
 }
 
 uint32_t LPTF_Packet::get_uint32(const std::string& name) const {
-    auto it = fields_.find(name);
-    if (it != fields_.end()) {
+    const DataValue* value = fields_.find(name);
+    if (value) {
         try {
-            return std::get<uint32_t>(it->second);
+            return std::get<uint32_t>(*value);
         } catch (const std::bad_variant_access&) {
             throw DeserializationException("Field '" + name + "' is not a uint32");
         }
@@ -138,10 +327,10 @@ uint32_t LPTF_Packet::get_uint32(const std::string& name) const {
 }
 
 uint64_t LPTF_Packet::get_uint64(const std::string& name) const {
-    auto it = fields_.find(name);
-    if (it != fields_.end()) {
+    const DataValue* value = fields_.find(name);
+    if (value) {
         try {
-            return std::get<uint64_t>(it->second);
+            return std::get<uint64_t>(*value);
         } catch (const std::bad_variant_access&) {
             throw DeserializationException("Field '" + name + "' is not a uint64");
         }
@@ -150,10 +339,10 @@ uint64_t LPTF_Packet::get_uint64(const std::string& name) const {
 }
 
 std::vector<uint8_t> LPTF_Packet::get_binary(const std::string& name) const {
-    auto it = fields_.find(name);
-    if (it != fields_.end()) {
+    const DataValue* value = fields_.find(name);
+    if (value) {
         try {
-            return std::get<std::vector<uint8_t>>(it->second);
+            return std::get<std::vector<uint8_t>>(*value);
         } catch (const std::bad_variant_access&) {
             throw DeserializationException("Field '" + name + "' is not binary data");
         }
@@ -161,14 +350,19 @@ std::vector<uint8_t> LPTF_Packet::get_binary(const std::string& name) const {
     throw DeserializationException("Field '" + name + "' not found");
 }
 
+const DataValue* LPTF_Packet::find_field(std::string_view name) const {
+    return fields_.find(name);
+}
+
 bool LPTF_Packet::has_field(const std::string& name) const {
-    return fields_.find(name) != fields_.end();
+    return fields_.contains(name);
 }
 
 std::vector<std::string> LPTF_Packet::get_field_names() const {
     std::vector<std::string> names;
-    for (const auto& pair : fields_) {
-        names.push_back(pair.first);
+    names.reserve(fields_.size());
+    for (const auto& field : fields_) {
+        names.emplace_back(field.name.view());
     }
     return names;
 }
@@ -186,7 +380,7 @@ uint8_t LPTF_Packet::get_flags() const {
 }
 
 uint32_t LPTF_Packet::get_payload_length() const {
-    return header_.payload_length;
+    return static_cast<uint32_t>(get_payload_size());
 }
 
 bool LPTF_Packet::has_flag(PacketFlags flag) const {
@@ -227,81 +421,145 @@ size_t LPTF_Packet::get_serialized_size(const DataValue& value) const {
     }, value);
 }
 
+size_t LPTF_Packet::get_payload_size() const {
+    size_t payload_size = 0;
+    for (const auto& field : fields_) {
+        const size_t data_len = get_serialized_size(field.value);
+        if (data_len > 0xFFFFFFFFu) {
+            throw SerializationException("Field '" + std::string(field.name.view()) + "' exceeds 4 GiB");
+        }
+        payload_size += 1 + field.name.view().length() + 1 + FieldLength::encoded_size(data_len) + data_len;
+    }
+    return payload_size;
+}
+
+size_t LPTF_Packet::serialized_size() const {
+    return sizeof(PacketHeader) + get_payload_size();
+}
+
 std::vector<uint8_t> LPTF_Packet::serialize() const {
     std::vector<uint8_t> buffer;
+    serialize_into(buffer);
+    return buffer;
+}
+
+size_t LPTF_Packet::serialize_into(std::vector<uint8_t>& buffer) const {
+    const size_t offset = buffer.size();
+    const size_t total = serialized_size();
+    if (compression_threshold_ == 0 || total - sizeof(PacketHeader) < compression_threshold_) {
+        buffer.resize(offset + total);
+        return serialize_into(buffer.data() + offset, total);
+    }
     
+    // Trame en clair dans un tampon temporaire, gardée si la compression n'y gagne rien
+    std::vector<uint8_t> plain(total);
+    serialize_into(plain.data(), total);
+    if (!Compression::compress_frame(plain.data(), total, buffer, compression_threshold_)) {
+        buffer.insert(buffer.end(), plain.begin(), plain.end());
+    }
+    return buffer.size() - offset;
+}
+
+size_t LPTF_Packet::serialize_into(uint8_t* buffer, size_t capacity) const {
+    const size_t payload_size = get_payload_size();
+    if (capacity < sizeof(PacketHeader) + payload_size) {
+        return 0;
+    }
     
-    size_t payload_size = 0;
+    size_t offset = serialize_header(buffer, static_cast<uint32_t>(payload_size));
     for (const auto& field : fields_) {
-        payload_size += 1; 
-        payload_size += field.first.length(); 
-        payload_size += 1; 
-        payload_size += 2; 
-        payload_size += get_serialized_size(field.second); 
+        offset += serialize_field(field.name.view(), field.value, buffer + offset);
     }
+    return offset;
+}
+
+// Valeur volumineuse transmise en place plutôt que recopiée dans le tampon
+static const uint8_t* get_gather_data(const DataValue& value, size_t inline_threshold) {
+    if (const std::vector<uint8_t>* binary = std::get_if<std::vector<uint8_t>>(&value)) {
+        return binary->size() >= inline_threshold && !binary->empty() ? binary->data() : nullptr;
+    }
+    if (const std::string* text = std::get_if<std::string>(&value)) {
+        return text->size() >= inline_threshold && !text->empty() ? reinterpret_cast<const uint8_t*>(text->data()) : nullptr;
+    }
+    return nullptr;
+}
+
+size_t LPTF_Packet::serialize_gather(std::vector<uint8_t>& scratch, std::vector<struct iovec>& iov,
+                                     size_t inline_threshold) const {
+    const size_t payload_size = get_payload_size();
     
+    // Dimensionne scratch une seule fois : les iovecs pointent dedans
+    size_t scratch_size = sizeof(PacketHeader);
+    for (const auto& field : fields_) {
+        scratch_size += 2 + field.name.view().length() + FieldLength::encoded_size(get_serialized_size(field.value));
+        if (!get_gather_data(field.value, inline_threshold)) {
+            scratch_size += get_serialized_size(field.value);
+        }
+    }
+    scratch.resize(scratch_size);
+    iov.clear();
     
-    const_cast<LPTF_Packet*>(this)->header_.payload_length = static_cast<uint32_t>(payload_size);
-    
-    
-    buffer.reserve(sizeof(PacketHeader) + payload_size);
-    
-    
-    serialize_header(buffer);
-    
+    uint8_t* base = scratch.data();
+    size_t offset = serialize_header(base, static_cast<uint32_t>(payload_size));
+    size_t pending = 0; // Début de la partie de scratch pas encore référencée
     
     for (const auto& field : fields_) {
-        serialize_field(field.first, field.second, buffer);
+        const uint8_t* external = get_gather_data(field.value, inline_threshold);
+        if (!external) {
+            offset += serialize_field(field.name.view(), field.value, base + offset);
+            continue;
+        }
+        offset += serialize_field_header(field.name.view(), field.value, base + offset);
+        iov.push_back({base + pending, offset - pending});
+        iov.push_back({const_cast<uint8_t*>(external), get_serialized_size(field.value)});
+        pending = offset;
+    }
+    if (offset > pending) {
+        iov.push_back({base + pending, offset - pending});
     }
     
-    return buffer;
+    return sizeof(PacketHeader) + payload_size;
 }
 
-void LPTF_Packet::serialize_header(std::vector<uint8_t>& buffer) const {
-   
+size_t LPTF_Packet::serialize_header(uint8_t* buffer, uint32_t payload_length) const {
     uint32_t magic = ByteOrder::hton32(header_.magic);
-    const uint8_t* magic_bytes = reinterpret_cast<const uint8_t*>(&magic);
-    buffer.insert(buffer.end(), magic_bytes, magic_bytes + 4);
-    
-   
-    buffer.push_back(header_.version);
-    
-    
-    buffer.push_back(header_.flags);
+    std::memcpy(buffer, &magic, 4);
     
+    buffer[4] = header_.version;
+    // COMPRESSED et FRAGMENTED décrivent l'encodage de la trame, pas le contenu du paquet
+    buffer[5] = header_.flags & ~static_cast<uint8_t>(static_cast<uint8_t>(PacketFlags::COMPRESSED) |
+                                                      static_cast<uint8_t>(PacketFlags::FRAGMENTED));
     
     uint16_t msg_type = ByteOrder::hton16(header_.message_type);
-    const uint8_t* type_bytes = reinterpret_cast<const uint8_t*>(&msg_type);
-    buffer.insert(buffer.end(), type_bytes, type_bytes + 2);
+    std::memcpy(buffer + 6, &msg_type, 2);
     
-   
-    uint32_t payload_len = ByteOrder::hton32(header_.payload_length);
-    const uint8_t* len_bytes = reinterpret_cast<const uint8_t*>(&payload_len);
-    buffer.insert(buffer.end(), len_bytes, len_bytes + 4);
+    uint32_t payload_len = ByteOrder::hton32(payload_length);
+    std::memcpy(buffer + 8, &payload_len, 4);
+    return sizeof(PacketHeader);
 }
 
-void LPTF_Packet::serialize_field(const std::string& name, const DataValue& value, std::vector<uint8_t>& buffer) const {
-   
-    buffer.push_back(static_cast<uint8_t>(name.length()));
-    
+size_t LPTF_Packet::serialize_field_header(std::string_view name, const DataValue& value, uint8_t* buffer) const {
+    size_t offset = 0;
+    buffer[offset++] = static_cast<uint8_t>(name.length());
     
-    buffer.insert(buffer.end(), name.begin(), name.end());
+    std::memcpy(buffer + offset, name.data(), name.length());
+    offset += name.length();
     
-  
-    buffer.push_back(static_cast<uint8_t>(get_data_type(value)));
+    buffer[offset++] = static_cast<uint8_t>(get_data_type(value));
     
-  
-    uint16_t data_len = ByteOrder::hton16(static_cast<uint16_t>(get_serialized_size(value)));
-    const uint8_t* len_bytes = reinterpret_cast<const uint8_t*>(&data_len);
-    buffer.insert(buffer.end(), len_bytes, len_bytes + 2);
+    return offset + FieldLength::write(get_serialized_size(value), buffer + offset);
+}
+
+size_t LPTF_Packet::serialize_field(std::string_view name, const DataValue& value, uint8_t* buffer) const {
+    const size_t offset = serialize_field_header(name, value, buffer);
+    const size_t value_size = get_serialized_size(value);
     
-   
-    std::visit([&buffer](const auto& v) {
+    std::visit([buffer, offset](const auto& v) {
         using T = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<T, std::string>) {
-            buffer.insert(buffer.end(), v.begin(), v.end());
-        } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
-            buffer.insert(buffer.end(), v.begin(), v.end());
+        if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>) {
+            if (!v.empty()) {
+                std::memcpy(buffer + offset, v.data(), v.size());
+            }
         } else if constexpr (std::is_arithmetic_v<T>) {
             T network_value = v;
             if constexpr (sizeof(T) == 2) {
@@ -325,35 +583,52 @@ void LPTF_Packet::serialize_field(const std::string& name, const DataValue& valu
                     network_value = ByteOrder::hton64(v);
                 }
             }
-            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&network_value);
-            buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            std::memcpy(buffer + offset, &network_value, sizeof(T));
         }
     }, value);
+    return offset + value_size;
 }
 
 bool LPTF_Packet::deserialize(const std::vector<uint8_t>& data) {
+    return deserialize(data.data(), data.size());
+}
+
+bool LPTF_Packet::deserialize(const uint8_t* data, size_t size) {
     clear();
     
-    if (data.size() < sizeof(PacketHeader)) {
+    if (size < sizeof(PacketHeader)) {
         return false;
     }
     
     size_t offset = 0;
     
     // Désérialiser le header
-    if (!deserialize_header(data, offset)) {
+    if (!deserialize_header(data, size, offset)) {
         return false;
     }
     
     // Vérifier la cohérence
-    if (data.size() < sizeof(PacketHeader) + header_.payload_length) {
+    if (size < sizeof(PacketHeader) + header_.payload_length) {
+        return false;
+    }
+    
+    // Un fragment seul n'est pas un paquet : FragmentReassembler d'abord
+    if (has_flag(PacketFlags::FRAGMENTED)) {
         return false;
     }
     
+    if (has_flag(PacketFlags::COMPRESSED)) {
+        std::vector<uint8_t> plain;
+        if (!Compression::decompress_frame(data, sizeof(PacketHeader) + header_.payload_length, plain)) {
+            return false;
+        }
+        return deserialize(plain.data(), plain.size());
+    }
+    
     // Désérialiser les fields
     size_t end_offset = sizeof(PacketHeader) + header_.payload_length;
     while (offset < end_offset) {
-        if (!deserialize_field(data, offset)) {
+        if (!deserialize_field(data, end_offset, offset)) {
             return false;
         }
     }
@@ -361,9 +636,9 @@ bool LPTF_Packet::deserialize(const std::vector<uint8_t>& data) {
     return true;
 }
 
-bool LPTF_Packet::deserialize_header(const std::vector<uint8_t>& data, size_t& offset) {
+bool LPTF_Packet::deserialize_header(const uint8_t* data, size_t size, size_t& offset) {
     // Magic number
-    if (offset + 4 > data.size()) return false;
+    if (offset + 4 > size) return false;
     std::memcpy(&header_.magic, &data[offset], 4);
     header_.magic = ByteOrder::ntoh32(header_.magic);
     offset += 4;
@@ -371,23 +646,23 @@ bool LPTF_Packet::deserialize_header(const std::vector<uint8_t>& data, size_t& o
     if (!validate_magic(header_.magic)) return false;
     
     // Version
-    if (offset + 1 > data.size()) return false;
+    if (offset + 1 > size) return false;
     header_.version = data[offset++];
     
     if (!validate_version(header_.version)) return false;
     
     // Flags
-    if (offset + 1 > data.size()) return false;
+    if (offset + 1 > size) return false;
     header_.flags = data[offset++];
     
     // Message type
-    if (offset + 2 > data.size()) return false;
+    if (offset + 2 > size) return false;
     std::memcpy(&header_.message_type, &data[offset], 2);
     header_.message_type = ByteOrder::ntoh16(header_.message_type);
     offset += 2;
     
     // Payload length
-    if (offset + 4 > data.size()) return false;
+    if (offset + 4 > size) return false;
     std::memcpy(&header_.payload_length, &data[offset], 4);
     header_.payload_length = ByteOrder::ntoh32(header_.payload_length);
     offset += 4;
@@ -395,33 +670,30 @@ bool LPTF_Packet::deserialize_header(const std::vector<uint8_t>& data, size_t& o
     return true;
 }
 
-bool LPTF_Packet::deserialize_field(const std::vector<uint8_t>& data, size_t& offset) {
+bool LPTF_Packet::deserialize_field(const uint8_t* data, size_t size, size_t& offset) {
     // Name length
-    if (offset + 1 > data.size()) return false;
+    if (offset + 1 > size) return false;
     uint8_t name_len = data[offset++];
     
     // Name
-    if (offset + name_len > data.size()) return false;
-    std::string name(data.begin() + offset, data.begin() + offset + name_len);
+    if (offset + name_len > size) return false;
+    std::string_view name(reinterpret_cast<const char*>(data + offset), name_len);
     offset += name_len;
     
     // Data type
-    if (offset + 1 > data.size()) return false;
+    if (offset + 1 > size) return false;
     DataType data_type = static_cast<DataType>(data[offset++]);
     
     // Data length
-    if (offset + 2 > data.size()) return false;
-    uint16_t data_len;
-    std::memcpy(&data_len, &data[offset], 2);
-    data_len = ByteOrder::ntoh16(data_len);
-    offset += 2;
+    size_t data_len = 0;
+    if (!FieldLength::read(data, size, offset, data_len)) return false;
     
     // Data value
-    if (offset + data_len > data.size()) return false;
+    if (data_len > size - offset) return false;
     
     switch (data_type) {
         case DataType::STRING: {
-            std::string value(data.begin() + offset, data.begin() + offset + data_len);
+            std::string value(reinterpret_cast<const char*>(data + offset), data_len);
             fields_[name] = value;
             break;
         }
@@ -442,7 +714,7 @@ bool LPTF_Packet::deserialize_field(const std::vector<uint8_t>& data, size_t& of
             break;
         }
         case DataType::BINARY: {
-            std::vector<uint8_t> value(data.begin() + offset, data.begin() + offset + data_len);
+            std::vector<uint8_t> value(data + offset, data + offset + data_len);
             fields_[name] = value;
             break;
         }
@@ -460,7 +732,7 @@ void LPTF_Packet::clear() {
 }
 
 size_t LPTF_Packet::size() const {
-    return sizeof(PacketHeader) + header_.payload_length;
+    return serialized_size();
 }
 
 bool LPTF_Packet::is_valid() const {
@@ -474,11 +746,11 @@ std::string LPTF_Packet::to_string() const {
     oss << "  Version: " << static_cast<int>(header_.version) << "\n";
     oss << "  Flags: 0x" << std::hex << static_cast<int>(header_.flags) << std::dec << "\n";
     oss << "  Message Type: " << header_.message_type << "\n";
-    oss << "  Payload Length: " << header_.payload_length << "\n";
+    oss << "  Payload Length: " << get_payload_length() << "\n";
     oss << "  Fields (" << fields_.size() << "):\n";
     
     for (const auto& field : fields_) {
-        oss << "    " << field.first << ": ";
+        oss << "    " << field.name.view() << ": ";
         std::visit([&oss](const auto& v) {
             using T = std::decay_t<decltype(v)>;
             if constexpr (std::is_same_v<T, std::string>) {
@@ -488,7 +760,7 @@ std::string LPTF_Packet::to_string() const {
             } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
                 oss << "[" << v.size() << " bytes]";
             }
-        }, field.second);
+        }, field.value);
         oss << "\n";
     }
     
@@ -507,12 +779,14 @@ void LPTF_Packet::copy_from(const LPTF_Packet& other) {
     header_ = other.header_;
     fields_ = other.fields_;
     raw_data_ = other.raw_data_;
+    compression_threshold_ = other.compression_threshold_;
 }
 
 void LPTF_Packet::move_from(LPTF_Packet&& other) noexcept {
     header_ = other.header_;
     fields_ = std::move(other.fields_);
     raw_data_ = std::move(other.raw_data_);
+    compression_threshold_ = other.compression_threshold_;
     other.reset();
 }
 
@@ -520,6 +794,7 @@ void LPTF_Packet::reset() {
     header_ = PacketHeader();
     fields_.clear();
     raw_data_.clear();
+    compression_threshold_ = 0;
 }
 
 bool LPTF_Packet::validate_magic(uint32_t magic) const {
@@ -535,26 +810,33 @@ bool LPTF_Packet::validate_version(uint8_t version) const {
 // ============================================================================
 
 LPTF_Packet ChatMessage::create(const std::string& username, const std::string& message, uint64_t timestamp) {
-    LPTF_Packet packet(MessageType::CHAT_MESSAGE);
-    packet.set_string("username", username);
-    packet.set_string("message", message);
-    packet.set_uint64("timestamp", timestamp);
-    return packet;
+    return ChatMessageSchema::to_packet(ChatMessageSchema::Values(message, timestamp, username));
 }
 
 bool ChatMessage::parse(const LPTF_Packet& packet, std::string& username, std::string& message, uint64_t& timestamp) {
-    if (packet.get_message_type() != MessageType::CHAT_MESSAGE) {
+    ChatMessageSchema::Values values;
+    if (!ChatMessageSchema::from_packet(packet, values)) {
         return false;
     }
-    
-    try {
-        username = packet.get_string("username");
-        message = packet.get_string("message");
-        timestamp = packet.get_uint64("timestamp");
-        return true;
-    } catch (const ProtocolException&) {
+    username = std::move(ChatMessageSchema::get<fields::Username>(values));
+    message = std::move(ChatMessageSchema::get<fields::Message>(values));
+    timestamp = ChatMessageSchema::get<fields::Timestamp>(values);
+    return true;
+}
+
+std::vector<uint8_t> ChatMessage::encode(const std::string& username, const std::string& message, uint64_t timestamp) {
+    return ChatMessageSchema::serialize(ChatMessageSchema::Values(message, timestamp, username));
+}
+
+bool ChatMessage::parse(const uint8_t* data, size_t size, std::string& username, std::string& message, uint64_t& timestamp) {
+    ChatMessageSchema::Values values;
+    if (!ChatMessageSchema::decode(data, size, values)) {
         return false;
     }
+    username = std::move(ChatMessageSchema::get<fields::Username>(values));
+    message = std::move(ChatMessageSchema::get<fields::Message>(values));
+    timestamp = ChatMessageSchema::get<fields::Timestamp>(values);
+    return true;
 }
 
 } // namespace LPTF
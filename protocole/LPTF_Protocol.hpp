@@ -5,8 +5,10 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
-#include <map>
+#include <array>
+#include <string_view>
 #include <variant>
+#include <sys/uio.h>
 
 namespace LPTF {
 
@@ -34,10 +36,14 @@ enum class MessageType : uint16_t {
     HELLO = 0x0001,
     CHAT_MESSAGE = 0x0002,
     DISCONNECT = 0x0003,
+    ROOM_JOIN = 0x0004,
+    ROOM_LEAVE = 0x0005,
     
     // Cercle 2 - Protocole binaire
     PROTOCOL_INFO = 0x0010,
     CAPABILITY_EXCHANGE = 0x0011,
+    STATS_REQUEST = 0x0012,
+    STATS_RESPONSE = 0x0013,
     
     // Cercle 3 - Contrôle à distance
     HOST_INFO_REQUEST = 0x0020,
@@ -76,6 +82,15 @@ enum class PacketFlags : uint8_t {
     PRIORITY_LOW = 0x20
 };
 
+// Codes transportés par les messages ERROR
+enum class ErrorCode : uint32_t {
+    UNKNOWN_MESSAGE_TYPE = 0x0001,
+    INVALID_PACKET = 0x0002,
+    INVALID_ROOM = 0x0003,
+    NOT_IN_ROOM = 0x0004,
+    MESSAGE_TOO_LARGE = 0x0005
+};
+
 // Structure du header LPTF (fixe 12 bytes)
 struct PacketHeader {
     uint32_t magic;           // Magic number: 0x4C505446 ("LPTF")
@@ -96,12 +111,83 @@ using DataValue = std::variant<
     std::vector<uint8_t>
 >;
 
+// Nom de champ court stocké en ligne (les noms LPTF font au plus 255 octets,
+// seuls les noms de plus de 23 caractères utilisent le tas)
+class FieldName {
+public:
+    static constexpr size_t INLINE_CAPACITY = 23;
+    
+private:
+    uint8_t size_;
+    char inline_[INLINE_CAPACITY];
+    std::unique_ptr<char[]> heap_;
+    
+public:
+    FieldName();
+    FieldName(std::string_view name);
+    FieldName(const FieldName& other);
+    FieldName& operator=(const FieldName& other);
+    ~FieldName() = default;
+    
+    FieldName(FieldName&& other) noexcept = default;
+    FieldName& operator=(FieldName&& other) noexcept = default;
+    
+    std::string_view view() const;
+    
+private:
+    void assign(std::string_view name);
+};
+
+// Stockage plat des champs d'un paquet : tableau contigu trié par nom avec
+// une capacité en ligne de 8 champs (au-delà, bascule sur un vector).
+// L'ordre d'itération reste trié par nom : l'encodage des paquets est inchangé.
+class FieldStore {
+public:
+    struct Field {
+        FieldName name;
+        DataValue value;
+    };
+    
+    static constexpr size_t INLINE_FIELDS = 8;
+    
+private:
+    std::array<Field, INLINE_FIELDS> inline_;
+    std::vector<Field> heap_;
+    size_t size_;
+    
+public:
+    FieldStore();
+    FieldStore(const FieldStore& other) = default;
+    FieldStore& operator=(const FieldStore& other) = default;
+    ~FieldStore() = default;
+    
+    FieldStore(FieldStore&& other) noexcept;
+    FieldStore& operator=(FieldStore&& other) noexcept;
+    
+    // Insère le champ (à sa place dans l'ordre) s'il n'existe pas
+    DataValue& operator[](std::string_view name);
+    const DataValue* find(std::string_view name) const;
+    bool contains(std::string_view name) const;
+    
+    size_t size() const;
+    bool empty() const;
+    void clear();
+    
+    const Field* begin() const;
+    const Field* end() const;
+    
+private:
+    Field* data();
+    const Field* data() const;
+};
+
 // Classe principale pour la gestion des paquets LPTF
 class LPTF_Packet {
 private:
     PacketHeader header_;
-    std::map<std::string, DataValue> fields_;
+    FieldStore fields_;
     std::vector<uint8_t> raw_data_;
+    size_t compression_threshold_; // 0 : jamais compressé
     
 public:
     // Constructeurs - Forme canonique de Coplien
@@ -121,9 +207,16 @@ public:
     void add_flag(PacketFlags flag);
     void remove_flag(PacketFlags flag);
     
+    // Compression à la sérialisation des payloads d'au moins threshold octets
+    // (0 la désactive). Ne s'active que vers un pair qui l'a acceptée par
+    // CAPABILITY_EXCHANGE ; serialize_into(buffer, capacity) et serialize_gather
+    // produisent toujours une trame non compressée.
+    void set_compression_threshold(size_t threshold);
+    size_t get_compression_threshold() const;
+    
     // Ajout de données typées
     template<typename T>
-    void set_field(const std::string& name, const T& value);
+    void set_field(std::string_view name, const T& value);
     
     // Méthodes spécialisées pour les types courants
     void set_string(const std::string& name, const std::string& value);
@@ -133,7 +226,10 @@ public:
     
     // Extraction de données
     template<typename T>
-    T get_field(const std::string& name) const;
+    T get_field(std::string_view name) const;
+    
+    // Accès sans exception : nullptr si le champ est absent
+    const DataValue* find_field(std::string_view name) const;
     
     std::string get_string(const std::string& name) const;
     uint32_t get_uint32(const std::string& name) const;
@@ -144,9 +240,26 @@ public:
     bool has_field(const std::string& name) const;
     std::vector<std::string> get_field_names() const;
     
-    // Sérialisation/Désérialisation
+    // Sérialisation/Désérialisation ; deserialize accepte les trames compressées
     std::vector<uint8_t> serialize() const;
+    
+    // Taille exacte de la trame (header + champs)
+    size_t serialized_size() const;
+    // Écrit la trame dans un tampon fourni par l'appelant ; retourne les octets
+    // écrits, 0 si capacity < serialized_size()
+    size_t serialize_into(uint8_t* buffer, size_t capacity) const;
+    // Ajoute la trame à la fin de buffer, compressée si le seuil est atteint
+    size_t serialize_into(std::vector<uint8_t>& buffer) const;
+    // Sérialisation scatter-gather : header et en-têtes de champs dans scratch,
+    // les valeurs STRING/BINARY d'au moins inline_threshold octets sont
+    // référencées en place. Les iovecs restent valides tant que le paquet et
+    // scratch ne sont pas modifiés. Retourne la taille totale de la trame.
+    size_t serialize_gather(std::vector<uint8_t>& scratch, std::vector<struct iovec>& iov,
+                            size_t inline_threshold = GATHER_INLINE_THRESHOLD) const;
+    
+    static constexpr size_t GATHER_INLINE_THRESHOLD = 1024;
     bool deserialize(const std::vector<uint8_t>& data);
+    bool deserialize(const uint8_t* data, size_t size);
     
     // Getters pour le header
     MessageType get_message_type() const;
@@ -167,11 +280,13 @@ public:
     
 private:
     // Méthodes privées pour la sérialisation
-    void serialize_header(std::vector<uint8_t>& buffer) const;
-    void serialize_field(const std::string& name, const DataValue& value, std::vector<uint8_t>& buffer) const;
+    size_t serialize_header(uint8_t* buffer, uint32_t payload_length) const;
+    size_t serialize_field(std::string_view name, const DataValue& value, uint8_t* buffer) const;
+    size_t serialize_field_header(std::string_view name, const DataValue& value, uint8_t* buffer) const;
+    size_t get_payload_size() const;
     
-    bool deserialize_header(const std::vector<uint8_t>& data, size_t& offset);
-    bool deserialize_field(const std::vector<uint8_t>& data, size_t& offset);
+    bool deserialize_header(const uint8_t* data, size_t size, size_t& offset);
+    bool deserialize_field(const uint8_t* data, size_t size, size_t& offset);
     
     DataType get_data_type(const DataValue& value) const;
     size_t get_serialized_size(const DataValue& value) const;
@@ -191,6 +306,10 @@ class ChatMessage {
 public:
     static LPTF_Packet create(const std::string& username, const std::string& message, uint64_t timestamp);
     static bool parse(const LPTF_Packet& packet, std::string& username, std::string& message, uint64_t& timestamp);
+    
+    // Chemin rapide : encodage/décodage direct de la trame via ChatMessageSchema
+    static std::vector<uint8_t> encode(const std::string& username, const std::string& message, uint64_t timestamp);
+    static bool parse(const uint8_t* data, size_t size, std::string& username, std::string& message, uint64_t& timestamp);
 };
 
 class ProtocolInfo {
@@ -213,6 +332,19 @@ public:
     static bool is_big_endian();
 };
 
+// Longueur d'une valeur de champ : u16, ou 0xFFFF suivi d'un u32 pour les
+// valeurs d'au moins 65535 octets (une valeur de 65535 octets prend donc la forme longue)
+class FieldLength {
+public:
+    static constexpr uint16_t EXTENDED = 0xFFFF;
+    
+    static size_t encoded_size(size_t length) { return length >= EXTENDED ? 6 : 2; }
+    // Retourne les octets écrits
+    static size_t write(size_t length, uint8_t* out);
+    // Lit la longueur à offset (avancé) ; false si elle dépasse end
+    static bool read(const uint8_t* data, size_t end, size_t& offset, size_t& length);
+};
+
 // Exceptions spécifiques au protocole
 class ProtocolException : public std::exception {
 private:
@@ -234,6 +366,24 @@ public:
         : ProtocolException("Deserialization error: " + message) {}
 };
 
+template<typename T>
+void LPTF_Packet::set_field(std::string_view name, const T& value) {
+    fields_[name] = value;
+}
+
+template<typename T>
+T LPTF_Packet::get_field(std::string_view name) const {
+    const DataValue* value = fields_.find(name);
+    if (!value) {
+        throw DeserializationException("Field '" + std::string(name) + "' not found");
+    }
+    const T* typed = std::get_if<T>(value);
+    if (!typed) {
+        throw DeserializationException("Field '" + std::string(name) + "' has an unexpected type");
+    }
+    return *typed;
+}
+
 } // namespace LPTF
 
 #endif // LPTF_PROTOCOL_HPP
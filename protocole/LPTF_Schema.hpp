@@ -0,0 +1,357 @@
+#ifndef LPTF_SCHEMA_HPP
+#define LPTF_SCHEMA_HPP
+
+#include "LPTF_Protocol.hpp"
+#include "LPTF_PacketView.hpp"
+#include <tuple>
+#include <utility>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace LPTF {
+
+// ============================================================================
+// Codecs par type C++ : type LPTF, taille et encodage résolus à la compilation
+// ============================================================================
+
+template<typename T>
+struct FieldCodec;
+
+template<>
+struct FieldCodec<uint32_t> {
+    static constexpr DataType type = DataType::UINT32;
+    static constexpr size_t fixed_size = 4;
+    static size_t size(const uint32_t&) { return 4; }
+    static void write(const uint32_t& value, uint8_t* out) {
+        const uint32_t net = ByteOrder::hton32(value);
+        std::memcpy(out, &net, 4);
+    }
+    static bool read(const uint8_t* in, size_t len, uint32_t& value) {
+        if (len != 4) return false;
+        std::memcpy(&value, in, 4);
+        value = ByteOrder::ntoh32(value);
+        return true;
+    }
+};
+
+template<>
+struct FieldCodec<uint64_t> {
+    static constexpr DataType type = DataType::UINT64;
+    static constexpr size_t fixed_size = 8;
+    static size_t size(const uint64_t&) { return 8; }
+    static void write(const uint64_t& value, uint8_t* out) {
+        const uint64_t net = ByteOrder::hton64(value);
+        std::memcpy(out, &net, 8);
+    }
+    static bool read(const uint8_t* in, size_t len, uint64_t& value) {
+        if (len != 8) return false;
+        std::memcpy(&value, in, 8);
+        value = ByteOrder::ntoh64(value);
+        return true;
+    }
+};
+
+template<>
+struct FieldCodec<std::string> {
+    static constexpr DataType type = DataType::STRING;
+    static constexpr size_t fixed_size = 0; // Taille variable
+    static size_t size(const std::string& value) { return value.size(); }
+    static void write(const std::string& value, uint8_t* out) {
+        std::memcpy(out, value.data(), value.size());
+    }
+    static bool read(const uint8_t* in, size_t len, std::string& value) {
+        value.assign(reinterpret_cast<const char*>(in), len);
+        return true;
+    }
+};
+
+template<>
+struct FieldCodec<std::vector<uint8_t>> {
+    static constexpr DataType type = DataType::BINARY;
+    static constexpr size_t fixed_size = 0; // Taille variable
+    static size_t size(const std::vector<uint8_t>& value) { return value.size(); }
+    static void write(const std::vector<uint8_t>& value, uint8_t* out) {
+        std::memcpy(out, value.data(), value.size());
+    }
+    static bool read(const uint8_t* in, size_t len, std::vector<uint8_t>& value) {
+        value.assign(in, in + len);
+        return true;
+    }
+};
+
+// ============================================================================
+// Descripteurs de champs : nom et type déclarés une seule fois
+// ============================================================================
+
+namespace fields {
+
+struct Active       { static constexpr std::string_view name = "active";       using type = uint32_t; };
+struct Architecture { static constexpr std::string_view name = "architecture"; using type = std::string; };
+struct CapturedKeys { static constexpr std::string_view name = "captured_keys"; using type = std::string; };
+struct Code         { static constexpr std::string_view name = "code";         using type = uint32_t; };
+struct Compression  { static constexpr std::string_view name = "compression";  using type = uint32_t; };
+struct CompressionThreshold { static constexpr std::string_view name = "compression_threshold"; using type = uint32_t; };
+struct ExitCode     { static constexpr std::string_view name = "exit_code";    using type = uint32_t; };
+struct Hostname     { static constexpr std::string_view name = "hostname";     using type = std::string; };
+struct LastSeq      { static constexpr std::string_view name = "last_seq";     using type = uint64_t; };
+struct Message      { static constexpr std::string_view name = "message";      using type = std::string; };
+struct OsName       { static constexpr std::string_view name = "os_name";      using type = std::string; };
+struct OsVersion    { static constexpr std::string_view name = "os_version";   using type = std::string; };
+struct Output       { static constexpr std::string_view name = "output";       using type = std::string; };
+struct ProcessCount { static constexpr std::string_view name = "process_count"; using type = uint32_t; };
+struct ProcessList  { static constexpr std::string_view name = "process_list"; using type = std::string; };
+struct RejectedType { static constexpr std::string_view name = "rejected_type"; using type = uint32_t; };
+struct Room         { static constexpr std::string_view name = "room";         using type = std::string; };
+struct Seq          { static constexpr std::string_view name = "seq";          using type = uint64_t; };
+struct Timestamp    { static constexpr std::string_view name = "timestamp";    using type = uint64_t; };
+struct Username     { static constexpr std::string_view name = "username";     using type = std::string; };
+
+} // namespace fields
+
+// ============================================================================
+// Schéma de message : sérialisation et parsing en ligne droite
+// ============================================================================
+
+// Les champs doivent être déclarés dans l'ordre des noms : c'est l'ordre
+// produit par LPTF_Packet::serialize, les trames sont donc identiques octet
+// pour octet et le décodage suit la trame sans recherche par nom.
+template<MessageType Type, typename... Fields>
+class MessageSchema {
+public:
+    using Values = std::tuple<typename Fields::type...>;
+    static constexpr MessageType message_type = Type;
+    static constexpr size_t HEADER_SIZE = 12;
+
+private:
+    static constexpr bool names_sorted() {
+        const std::string_view names[] = {Fields::name...};
+        for (size_t i = 1; i < sizeof...(Fields); ++i) {
+            if (!(names[i - 1] < names[i])) {
+                return false;
+            }
+        }
+        for (const std::string_view& name : names) {
+            if (name.size() > 255) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(sizeof...(Fields) > 0, "Un schéma doit déclarer au moins un champ");
+    static_assert(names_sorted(), "Les champs d'un schéma doivent être triés par nom (max 255 octets)");
+
+public:
+    // Position d'un descripteur dans la liste des champs
+    template<typename F>
+    static constexpr size_t index_of() {
+        constexpr bool matches[] = {std::is_same<F, Fields>::value...};
+        size_t index = 0;
+        while (index < sizeof...(Fields) && !matches[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+    template<typename F>
+    static typename F::type& get(Values& values) {
+        static_assert(index_of<F>() < sizeof...(Fields), "Champ absent du schéma");
+        return std::get<index_of<F>()>(values);
+    }
+
+    template<typename F>
+    static const typename F::type& get(const Values& values) {
+        static_assert(index_of<F>() < sizeof...(Fields), "Champ absent du schéma");
+        return std::get<index_of<F>()>(values);
+    }
+
+    // Taille des parties fixes (header, en-têtes de champs, valeurs de taille fixe) ;
+    // une valeur d'au moins 65535 octets ajoute 4 octets de longueur étendue
+    static constexpr size_t fixed_size() {
+        return HEADER_SIZE + ((4 + Fields::name.size() + FieldCodec<typename Fields::type>::fixed_size) + ...);
+    }
+
+    static size_t serialized_size(const Values& values) {
+        return serialized_size(values, std::index_sequence_for<Fields...>());
+    }
+
+    // Écrit la trame complète dans out (serialized_size(values) octets), retourne la taille écrite
+    static size_t encode(const Values& values, uint8_t* out) {
+        return encode(values, out, std::index_sequence_for<Fields...>());
+    }
+
+    static std::vector<uint8_t> serialize(const Values& values) {
+        std::vector<uint8_t> buffer(serialized_size(values));
+        encode(values, buffer.data());
+        return buffer;
+    }
+
+    // Décodage direct d'une trame ; si l'émetteur a ordonné les champs
+    // autrement, repli sur une recherche par nom dans une LPTF_PacketView
+    static bool decode(const uint8_t* data, size_t size, Values& values) {
+        if (size < HEADER_SIZE) {
+            return false;
+        }
+        uint32_t magic;
+        uint16_t type;
+        uint32_t payload_length;
+        std::memcpy(&magic, data, 4);
+        std::memcpy(&type, data + 6, 2);
+        std::memcpy(&payload_length, data + 8, 4);
+        payload_length = ByteOrder::ntoh32(payload_length);
+        if (ByteOrder::ntoh32(magic) != 0x4C505446 || !LPTF_Packet::is_compatible_version(data[4]) ||
+            ByteOrder::ntoh16(type) != static_cast<uint16_t>(Type) || size - HEADER_SIZE < payload_length) {
+            return false;
+        }
+
+        const size_t end = HEADER_SIZE + payload_length;
+        size_t offset = HEADER_SIZE;
+        if (decode_in_order(data, end, offset, values, std::index_sequence_for<Fields...>()) && offset == end) {
+            return true;
+        }
+        return decode_by_name(data, end, values, std::index_sequence_for<Fields...>());
+    }
+
+    // Passerelles avec LPTF_Packet (sans exception ni bad_variant_access)
+    static LPTF_Packet to_packet(const Values& values) {
+        LPTF_Packet packet(Type);
+        (packet.set_field(Fields::name, std::get<index_of<Fields>()>(values)), ...);
+        return packet;
+    }
+
+    static bool from_packet(const LPTF_Packet& packet, Values& values) {
+        if (packet.get_message_type() != Type) {
+            return false;
+        }
+        return (load_from_packet<Fields>(packet, std::get<index_of<Fields>()>(values)) && ...);
+    }
+
+private:
+    template<size_t... Is>
+    static size_t serialized_size(const Values& values, std::index_sequence<Is...>) {
+        return fixed_size() + ((FieldCodec<typename Fields::type>::fixed_size == 0 ?
+                                variable_size(FieldCodec<typename Fields::type>::size(std::get<Is>(values))) : 0) + ...);
+    }
+
+    static size_t variable_size(size_t length) {
+        return length + FieldLength::encoded_size(length) - 2;
+    }
+
+    template<size_t... Is>
+    static size_t encode(const Values& values, uint8_t* out, std::index_sequence<Is...>) {
+        const size_t total = serialized_size(values);
+        const uint32_t magic = ByteOrder::hton32(0x4C505446);
+        const uint16_t type = ByteOrder::hton16(static_cast<uint16_t>(Type));
+        const uint32_t payload_length = ByteOrder::hton32(static_cast<uint32_t>(total - HEADER_SIZE));
+        std::memcpy(out, &magic, 4);
+        out[4] = 1;
+        out[5] = 0;
+        std::memcpy(out + 6, &type, 2);
+        std::memcpy(out + 8, &payload_length, 4);
+
+        size_t offset = HEADER_SIZE;
+        (encode_field<Fields>(std::get<Is>(values), out, offset), ...);
+        return offset;
+    }
+
+    template<typename F>
+    static void encode_field(const typename F::type& value, uint8_t* out, size_t& offset) {
+        using Codec = FieldCodec<typename F::type>;
+        constexpr std::string_view name = F::name;
+        const size_t len = Codec::size(value);
+        if (len > 0xFFFFFFFFu) {
+            throw SerializationException("Field '" + std::string(name) + "' exceeds 4 GiB");
+        }
+        out[offset++] = static_cast<uint8_t>(name.size());
+        std::memcpy(out + offset, name.data(), name.size());
+        offset += name.size();
+        out[offset++] = static_cast<uint8_t>(Codec::type);
+        offset += FieldLength::write(len, out + offset);
+        Codec::write(value, out + offset);
+        offset += len;
+    }
+
+    template<size_t... Is>
+    static bool decode_in_order(const uint8_t* data, size_t end, size_t& offset, Values& values, std::index_sequence<Is...>) {
+        return (decode_field<Fields>(data, end, offset, std::get<Is>(values)) && ...);
+    }
+
+    template<typename F>
+    static bool decode_field(const uint8_t* data, size_t end, size_t& offset, typename F::type& value) {
+        using Codec = FieldCodec<typename F::type>;
+        constexpr std::string_view name = F::name;
+        if (offset + 4 + name.size() > end || data[offset] != name.size() ||
+            std::memcmp(data + offset + 1, name.data(), name.size()) != 0) {
+            return false;
+        }
+        size_t pos = offset + 1 + name.size();
+        if (data[pos] != static_cast<uint8_t>(Codec::type)) {
+            return false;
+        }
+        pos += 1;
+        size_t len = 0;
+        if (!FieldLength::read(data, end, pos, len) || len > end - pos || !Codec::read(data + pos, len, value)) {
+            return false;
+        }
+        offset = pos + len;
+        return true;
+    }
+
+    template<size_t... Is>
+    static bool decode_by_name(const uint8_t* data, size_t end, Values& values, std::index_sequence<Is...>) {
+        LPTF_PacketView view(data, end);
+        if (!view.is_valid()) {
+            return false;
+        }
+        return (decode_from_view<Fields>(view, std::get<Is>(values)) && ...);
+    }
+
+    template<typename F>
+    static bool decode_from_view(const LPTF_PacketView& view, typename F::type& value) {
+        using Codec = FieldCodec<typename F::type>;
+        FieldView field;
+        return view.find_field(F::name, field) && field.type == Codec::type &&
+               Codec::read(field.value.data, field.value.size, value);
+    }
+
+    template<typename F>
+    static bool load_from_packet(const LPTF_Packet& packet, typename F::type& value) {
+        const DataValue* stored = packet.find_field(F::name);
+        const typename F::type* typed = stored ? std::get_if<typename F::type>(stored) : nullptr;
+        if (!typed) {
+            return false;
+        }
+        value = *typed;
+        return true;
+    }
+};
+
+// ============================================================================
+// Schémas des messages
+// ============================================================================
+
+using ChatMessageSchema = MessageSchema<MessageType::CHAT_MESSAGE,
+    fields::Message, fields::Timestamp, fields::Username>;
+
+// Salons : un CHAT_MESSAGE peut porter en plus un champ "room" (salon par défaut sinon)
+using RoomJoinSchema = MessageSchema<MessageType::ROOM_JOIN, fields::Room>;
+using RoomLeaveSchema = MessageSchema<MessageType::ROOM_LEAVE, fields::Room>;
+
+// Historique : les CHAT_MESSAGE relayés portent leur numéro "seq" dans le salon.
+// Un ROOM_JOIN avec last_seq rejoue les messages manquants ; l'ACK donne la dernière séquence
+using RoomResumeSchema = MessageSchema<MessageType::ROOM_JOIN, fields::LastSeq, fields::Room>;
+using RoomAckSchema = MessageSchema<MessageType::ACK, fields::Room, fields::Seq>;
+
+// Négociation : masque des codecs acceptés (Compression::CODEC_*) et taille de
+// payload minimale à compresser ; la réponse donne le masque retenu
+using CapabilitySchema = MessageSchema<MessageType::CAPABILITY_EXCHANGE,
+    fields::Compression, fields::CompressionThreshold>;
+
+// code : ErrorCode, rejected_type : type du message refusé
+using ErrorSchema = MessageSchema<MessageType::ERROR,
+    fields::Code, fields::Message, fields::RejectedType>;
+
+} // namespace LPTF
+
+#endif // LPTF_SCHEMA_HPP
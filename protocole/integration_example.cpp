@@ -1,5 +1,6 @@
 #include "../server/LPTF_socket.hpp"
 #include "LPTF_Protocol.hpp"
+#include "LPTF_Framing.hpp"
 #include <iostream>
 
 class LPTF_Server {
@@ -26,30 +27,39 @@ public:
     bool send_packet(LPTF_Socket& socket, const LPTF::LPTF_Packet& packet) {
         try {
             std::vector<uint8_t> data = packet.serialize();
-            std::string str_data(data.begin(), data.end());
-            return socket.send_data(str_data) > 0;
+            return socket.send_raw(data.data(), data.size()) > 0;
         } catch (const std::exception& e) {
             std::cerr << "Protocol error: " << e.what() << std::endl;
             return false;
         }
     }
     
-    bool receive_packet(LPTF_Socket& socket, LPTF::LPTF_Packet& packet) {
-        std::string str_data;
-        ssize_t received = socket.receive_data(str_data);
+    // Une trame peut arriver en plusieurs segments TCP ou plusieurs trames dans un seul :
+    // le reassembler de la connexion conserve les octets entre deux appels
+    bool receive_packet(LPTF_Socket& socket, LPTF::FrameReassembler& reassembler, LPTF::LPTF_Packet& packet) {
+        const uint8_t* frame = nullptr;
+        size_t frame_size = 0;
         
-        if (received <= 0) return false;
+        while (!reassembler.next_frame(frame, frame_size)) {
+            if (reassembler.is_corrupted()) return false;
+            
+            uint8_t* buffer = reassembler.prepare(4096);
+            ssize_t received = socket.receive_raw(buffer, reassembler.writable_size());
+            if (received <= 0) return false;
+            reassembler.commit(received);
+        }
         
-        std::vector<uint8_t> data(str_data.begin(), str_data.end());
-        return packet.deserialize(data);
+        return packet.deserialize(frame, frame_size);
     }
     
+    // Sérialisation unique : tous les clients reçoivent le même tampon
     void broadcast_chat(const std::string& username, const std::string& message, uint64_t timestamp) {
         LPTF::LPTF_Packet packet = LPTF::ChatMessage::create(username, message, timestamp);
+        std::vector<uint8_t> data = packet.serialize();
         
         for (auto& client : clients_) {
             if (client && client->get_is_connected()) {
-                send_packet(*client, packet);
+                client->send_raw(data.data(), data.size());
             }
         }
     }
@@ -0,0 +1,161 @@
+#include "ConnectionSlab.hpp"
+#include <utility>
+
+ConnectionSlab::ConnectionSlab() {
+}
+
+ConnectionSlab::ConnectionSlab(size_t capacity) {
+    reserve(capacity);
+}
+
+ConnectionSlab::ConnectionSlab(const ConnectionSlab& other) {
+    reserve(other.capacity());
+}
+
+ConnectionSlab& ConnectionSlab::operator=(const ConnectionSlab& other) {
+    if (this != &other) {
+        reserve(other.capacity());
+    }
+    return *this;
+}
+
+ConnectionSlab::ConnectionSlab(ConnectionSlab&& other) noexcept
+    : slots_(std::move(other.slots_)), free_slots_(std::move(other.free_slots_)),
+      fd_index_(std::move(other.fd_index_)), active_(std::move(other.active_)) {
+}
+
+ConnectionSlab& ConnectionSlab::operator=(ConnectionSlab&& other) noexcept {
+    if (this != &other) {
+        slots_ = std::move(other.slots_);
+        free_slots_ = std::move(other.free_slots_);
+        fd_index_ = std::move(other.fd_index_);
+        active_ = std::move(other.active_);
+    }
+    return *this;
+}
+
+void ConnectionSlab::reserve(size_t capacity) {
+    // Les emplacements ne sont jamais déplacés ensuite : les pointeurs restent valides
+    slots_ = std::vector<ClientState>(capacity);
+    free_slots_.clear();
+    free_slots_.reserve(capacity);
+    for (size_t i = capacity; i > 0; --i) {
+        free_slots_.push_back(static_cast<uint32_t>(i - 1));
+    }
+    fd_index_.clear();
+    active_.clear();
+    active_.reserve(capacity);
+}
+
+void ConnectionSlab::clear() {
+    while (!active_.empty()) {
+        release(slots_[active_.back()]);
+    }
+}
+
+ClientState* ConnectionSlab::acquire() {
+    if (free_slots_.empty()) {
+        return nullptr;
+    }
+    ClientState& state = slots_[free_slots_.back()];
+    free_slots_.pop_back();
+
+    // Génération 0 réservée : un handle nul ne désigne jamais une connexion
+    if (++state.generation == 0) {
+        state.generation = 1;
+    }
+    state.in_use = true;
+    state.address[0] = '\0';
+    state.input.clear();
+    state.fragments.clear();
+    state.mode = InputMode::DETECT;
+    state.output.clear();
+    state.want_write = false;
+    state.closing = false;
+    state.compression = false;
+    state.last_input_ms = 0;
+    state.last_output_ms = 0;
+    state.ping_sent_ms = 0;
+    state.idle_timer = TimerWheel::INVALID_TIMER;
+    state.write_timer = TimerWheel::INVALID_TIMER;
+    state.rooms.clear();
+    state.active_index = static_cast<uint32_t>(active_.size());
+    active_.push_back(slot_of(state));
+    return &state;
+}
+
+bool ConnectionSlab::bind_fd(ClientState& state) {
+    const int fd = state.socket.get_socket_fd();
+    if (fd < 0 || !state.in_use) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= fd_index_.size()) {
+        fd_index_.resize(fd + 1, -1);
+    }
+    fd_index_[fd] = static_cast<int>(slot_of(state));
+    return true;
+}
+
+void ConnectionSlab::release(ClientState& state) {
+    if (!state.in_use) {
+        return;
+    }
+    const int fd = state.socket.get_socket_fd();
+    if (fd >= 0 && static_cast<size_t>(fd) < fd_index_.size() &&
+        fd_index_[fd] == static_cast<int>(slot_of(state))) {
+        fd_index_[fd] = -1;
+    }
+    state.socket.close_socket();
+    state.in_use = false;
+    state.closing = false;
+    state.compression = false;
+    state.want_write = false;
+    state.output.clear();
+    state.input.clear();
+    state.fragments.clear();
+    
+    // Le dernier actif prend la place de l'emplacement retiré
+    const uint32_t last = active_.back();
+    active_[state.active_index] = last;
+    slots_[last].active_index = state.active_index;
+    active_.pop_back();
+    
+    free_slots_.push_back(slot_of(state));
+}
+
+ClientState* ConnectionSlab::find(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= fd_index_.size() || fd_index_[fd] == -1) {
+        return nullptr;
+    }
+    return &slots_[fd_index_[fd]];
+}
+
+ClientState* ConnectionSlab::resolve(Handle handle) {
+    const uint32_t slot = static_cast<uint32_t>(handle & 0xFFFFFFFFu);
+    const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (generation == 0 || slot >= slots_.size()) {
+        return nullptr;
+    }
+    ClientState& state = slots_[slot];
+    return state.in_use && state.generation == generation ? &state : nullptr;
+}
+
+ConnectionSlab::Handle ConnectionSlab::get_handle(const ClientState& state) const {
+    return (static_cast<Handle>(state.generation) << 32) | slot_of(state);
+}
+
+size_t ConnectionSlab::size() const {
+    return active_.size();
+}
+
+size_t ConnectionSlab::capacity() const {
+    return slots_.size();
+}
+
+bool ConnectionSlab::full() const {
+    return free_slots_.empty();
+}
+
+uint32_t ConnectionSlab::slot_of(const ClientState& state) const {
+    return static_cast<uint32_t>(&state - slots_.data());
+}
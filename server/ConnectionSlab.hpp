@@ -0,0 +1,113 @@
+#ifndef CONNECTION_SLAB_HPP
+#define CONNECTION_SLAB_HPP
+
+#include "LPTF_socket.hpp"
+#include "WriteQueue.hpp"
+#include "TimerWheel.hpp"
+#include "../protocole/LPTF_Framing.hpp"
+#include "../protocole/LPTF_Fragment.hpp"
+#include <vector>
+#include <cstdint>
+
+// Format du flux entrant, déterminé par les premiers octets reçus
+enum class InputMode {
+    DETECT,  // Aucun octet reçu pour l'instant
+    TEXT,    // Chat texte historique : un message par ligne
+    FRAMED   // Trames LPTF (magic "LPTF")
+};
+
+// Appartenance d'un client à un salon : position du client dans la liste du salon
+struct RoomMembership {
+    uint32_t room;
+    uint32_t position;
+};
+
+// État d'un client : socket, adresse, tampon de lecture et file d'envoi.
+// Les emplacements sont réutilisés d'une connexion à l'autre avec leurs tampons.
+struct ClientState {
+    LPTF_Socket socket;
+    char address[32];             // "ip:port", formaté une seule fois à l'accept
+    LPTF::FrameReassembler input; // Réutilisé d'un réveil à l'autre
+    LPTF::FragmentReassembler fragments; // Messages fragmentés en cours de réception
+    InputMode mode;
+    WriteQueue output;
+    uint32_t generation;          // Incrémentée à chaque réutilisation de l'emplacement
+    uint32_t active_index;        // Position dans la liste dense des connexions actives
+    uint64_t last_input_ms;       // Dernière réception (horloge du Reactor)
+    uint64_t last_output_ms;      // Dernier envoi ayant progressé
+    uint64_t ping_sent_ms;        // PING sans réponse en cours (0 sinon)
+    TimerWheel::TimerId idle_timer;  // Keepalive puis détection du pair mort
+    TimerWheel::TimerId write_timer; // Délai d'écriture, armé tant que la file n'est pas vide
+    std::vector<RoomMembership> rooms; // Salons rejoints (tenus à jour par RoomIndex)
+    bool in_use;
+    bool want_write;  // POLLOUT demandé au Reactor
+    bool closing;     // Fermeture différée à la fin de l'itération
+    bool compression; // Trames compressées acceptées (CAPABILITY_EXCHANGE)
+
+    ClientState() : mode(InputMode::DETECT), generation(0), active_index(0),
+                    last_input_ms(0), last_output_ms(0), ping_sent_ms(0),
+                    idle_timer(TimerWheel::INVALID_TIMER), write_timer(TimerWheel::INVALID_TIMER),
+                    in_use(false), want_write(false), closing(false), compression(false) {
+        address[0] = '\0';
+    }
+};
+
+// Slab de connexions à capacité fixe : tous les emplacements sont alloués au
+// démarrage, retrouvés en O(1) par fd ou par handle (emplacement + génération).
+// Les vagues de connexions/déconnexions ne touchent plus à malloc, et un retrait
+// coûte O(1) (échange avec le dernier élément de la liste dense des actifs).
+class ConnectionSlab {
+public:
+    // Identifiant stable d'une connexion : un handle périmé ne résout plus rien
+    using Handle = uint64_t;
+    static constexpr Handle INVALID_HANDLE = 0;
+
+private:
+    std::vector<ClientState> slots_;
+    std::vector<uint32_t> free_slots_; // Pile des emplacements libres
+    std::vector<int> fd_index_;        // fd -> emplacement (-1 si absent)
+    std::vector<uint32_t> active_;     // Emplacements occupés, sans trous
+
+public:
+    // Forme canonique de Coplien (une copie est un slab vide de même capacité)
+    ConnectionSlab();
+    explicit ConnectionSlab(size_t capacity);
+    ConnectionSlab(const ConnectionSlab& other);
+    ConnectionSlab& operator=(const ConnectionSlab& other);
+    ~ConnectionSlab() = default;
+
+    ConnectionSlab(ConnectionSlab&& other) noexcept;
+    ConnectionSlab& operator=(ConnectionSlab&& other) noexcept;
+
+    // Alloue les emplacements (ferme les connexions existantes)
+    void reserve(size_t capacity);
+    void clear();
+
+    // Emplacement libre, prêt à recevoir une socket ; nullptr si le slab est plein
+    ClientState* acquire();
+    // Associe l'emplacement acquis au fd de sa socket
+    bool bind_fd(ClientState& state);
+    // Ferme la socket et rend l'emplacement (les tampons gardent leur capacité)
+    void release(ClientState& state);
+
+    ClientState* find(int fd);
+    ClientState* resolve(Handle handle);
+    Handle get_handle(const ClientState& state) const;
+
+    size_t size() const;
+    size_t capacity() const;
+    bool full() const;
+
+    // Parcours des seules connexions actives ; fn ne doit pas appeler release()
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        for (size_t i = 0; i < active_.size(); ++i) {
+            fn(slots_[active_[i]]);
+        }
+    }
+
+private:
+    uint32_t slot_of(const ClientState& state) const;
+};
+
+#endif // CONNECTION_SLAB_HPP
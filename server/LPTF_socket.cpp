@@ -1,7 +1,9 @@
 #include "LPTF_socket.hpp"
-#include <iostream>
+#include "Logger.hpp"
 #include <cstring>
 #include <errno.h>
+#include <climits>
+#include <cstdio>
 
 // Constructeur par défaut
 LPTF_Socket::LPTF_Socket() 
@@ -53,33 +55,51 @@ LPTF_Socket::~LPTF_Socket() {
 }
 
 // Création de la socket
-bool LPTF_Socket::create_socket() {
+bool LPTF_Socket::create_socket(bool reuse_port) {
+    // Une socket déjà créée (ex: par le constructeur) est remplacée
+    close_socket();
+    
     socket_fd_ = socket(AF_INET, SOCK_STREAM, 0);
     if (socket_fd_ == -1) {
-        std::cerr << "Erreur lors de la création de la socket: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors de la création de la socket: ", strerror(errno));
         return false;
     }
     
     // Option pour réutiliser l'adresse
     int opt = 1;
     if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
-        std::cerr << "Erreur lors du setsockopt: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors du setsockopt: ", strerror(errno));
         close_socket();
         return false;
     }
     
+    // Plusieurs sockets d'écoute sur le même port : le noyau répartit les connexions
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+            LPTF_LOG_ERROR("Erreur lors du setsockopt SO_REUSEPORT: ", strerror(errno));
+            close_socket();
+            return false;
+        }
+#else
+        LPTF_LOG_ERROR("SO_REUSEPORT non supporté sur cette plateforme");
+        close_socket();
+        return false;
+#endif
+    }
+    
     return true;
 }
 
 // Liaison de la socket (pour le serveur)
 bool LPTF_Socket::bind_socket() {
     if (socket_fd_ == -1) {
-        std::cerr << "Socket non créée" << std::endl;
+        LPTF_LOG_ERROR("Socket non créée");
         return false;
     }
     
     if (bind(socket_fd_, reinterpret_cast<struct sockaddr*>(&address_), sizeof(address_)) == -1) {
-        std::cerr << "Erreur lors du bind: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors du bind: ", strerror(errno));
         return false;
     }
     
@@ -89,12 +109,12 @@ bool LPTF_Socket::bind_socket() {
 // Écoute des connexions (pour le serveur)
 bool LPTF_Socket::listen_socket(int backlog) {
     if (socket_fd_ == -1) {
-        std::cerr << "Socket non créée" << std::endl;
+        LPTF_LOG_ERROR("Socket non créée");
         return false;
     }
     
     if (listen(socket_fd_, backlog) == -1) {
-        std::cerr << "Erreur lors du listen: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors du listen: ", strerror(errno));
         return false;
     }
     
@@ -103,40 +123,88 @@ bool LPTF_Socket::listen_socket(int backlog) {
 
 // Acceptation d'une connexion (pour le serveur)
 std::unique_ptr<LPTF_Socket> LPTF_Socket::accept_connection() {
-    if (socket_fd_ == -1) {
-        std::cerr << "Socket non créée" << std::endl;
+    auto client_socket = std::make_unique<LPTF_Socket>();
+    if (!accept_into(*client_socket)) {
         return nullptr;
     }
+    return client_socket;
+}
+
+// Acceptation dans une socket existante (emplacement réutilisé, sans allocation)
+bool LPTF_Socket::accept_into(LPTF_Socket& client_socket, bool non_blocking) {
+    if (socket_fd_ == -1) {
+        LPTF_LOG_ERROR("Socket non créée");
+        return false;
+    }
     
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
     
+#ifdef __linux__
+    // Non-bloquant et close-on-exec positionnés par le même appel système
+    int client_fd = accept4(socket_fd_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len,
+                            SOCK_CLOEXEC | (non_blocking ? SOCK_NONBLOCK : 0));
+#else
     int client_fd = accept(socket_fd_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+#endif
     if (client_fd == -1) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "Erreur lors de l'accept: " << strerror(errno) << std::endl;
+        // errno est conservé pour l'appelant, qui distingue EAGAIN d'EMFILE
+        const int error = errno;
+        if (error != EAGAIN && error != EWOULDBLOCK && error != EMFILE && error != ENFILE) {
+            LPTF_LOG_WARN("Erreur lors de l'accept: ", strerror(error));
         }
-        return nullptr;
+        errno = error;
+        return false;
     }
     
-    auto client_socket = std::make_unique<LPTF_Socket>();
-    client_socket->socket_fd_ = client_fd;
-    client_socket->address_ = client_addr;
-    client_socket->is_server_ = false;
-    client_socket->is_connected_ = true;
+    client_socket.close_socket();
+    client_socket.socket_fd_ = client_fd;
+    client_socket.address_ = client_addr;
+    client_socket.is_server_ = false;
+    client_socket.is_connected_ = true;
     
-    return client_socket;
+#ifndef __linux__
+    if (non_blocking) {
+        client_socket.set_non_blocking(true);
+    }
+#endif
+    
+    return true;
+}
+
+void LPTF_Socket::attach(int fd) {
+    close_socket();
+    socket_fd_ = fd;
+    is_server_ = false;
+    is_connected_ = fd != -1;
+}
+
+// Adresse "ip:port" écrite dans un tampon fourni, sans allocation
+size_t LPTF_Socket::format_address(char* buffer, size_t size) const {
+    if (size == 0) {
+        return 0;
+    }
+    char ip[INET_ADDRSTRLEN];
+    if (!inet_ntop(AF_INET, &address_.sin_addr, ip, sizeof(ip))) {
+        ip[0] = '\0';
+    }
+    int written = snprintf(buffer, size, "%s:%d", ip, ntohs(address_.sin_port));
+    if (written < 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return static_cast<size_t>(written) < size ? static_cast<size_t>(written) : size - 1;
 }
 
 // Connexion au serveur (pour le client)
 bool LPTF_Socket::connect_to_server() {
     if (socket_fd_ == -1) {
-        std::cerr << "Socket non créée" << std::endl;
+        LPTF_LOG_ERROR("Socket non créée");
         return false;
     }
     
     if (connect(socket_fd_, reinterpret_cast<struct sockaddr*>(&address_), sizeof(address_)) == -1) {
-        std::cerr << "Erreur lors de la connexion: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors de la connexion: ", strerror(errno));
         return false;
     }
     
@@ -147,13 +215,34 @@ bool LPTF_Socket::connect_to_server() {
 // Envoi de données
 ssize_t LPTF_Socket::send_data(const std::string& data) const {
     if (socket_fd_ == -1 || !is_connected_) {
-        std::cerr << "Socket non connectée" << std::endl;
+        LPTF_LOG_WARN("Socket non connectée");
         return -1;
     }
     
     ssize_t bytes_sent = send(socket_fd_, data.c_str(), data.length(), 0);
     if (bytes_sent == -1) {
-        std::cerr << "Erreur lors de l'envoi: " << strerror(errno) << std::endl;
+        LPTF_LOG_DEBUG("Erreur lors de l'envoi: ", strerror(errno));
+    }
+    
+    return bytes_sent;
+}
+
+// Envoi d'un tampon binaire sans copie intermédiaire
+ssize_t LPTF_Socket::send_raw(const void* data, size_t size) const {
+    if (socket_fd_ == -1 || !is_connected_) {
+        LPTF_LOG_WARN("Socket non connectée");
+        return -1;
+    }
+    
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    
+    ssize_t bytes_sent = send(socket_fd_, data, size, flags);
+    if (bytes_sent == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        LPTF_LOG_DEBUG("Erreur lors de l'envoi: ", strerror(errno));
     }
     
     return bytes_sent;
@@ -162,16 +251,20 @@ ssize_t LPTF_Socket::send_data(const std::string& data) const {
 // Réception de données
 ssize_t LPTF_Socket::receive_data(std::string& data, size_t buffer_size) const {
     if (socket_fd_ == -1 || !is_connected_) {
-        std::cerr << "Socket non connectée" << std::endl;
+        LPTF_LOG_WARN("Socket non connectée");
         return -1;
     }
     
-    std::vector<char> buffer(buffer_size);
-    ssize_t bytes_received = recv(socket_fd_, buffer.data(), buffer_size - 1, 0);
+    // Réception directe dans la chaîne de l'appelant : pas de tampon intermédiaire
+    data.resize(buffer_size - 1);
+    ssize_t bytes_received = recv(socket_fd_, &data[0], buffer_size - 1, 0);
+    if (bytes_received <= 0) {
+        data.clear();
+    }
     
     if (bytes_received == -1) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "Erreur lors de la réception: " << strerror(errno) << std::endl;
+            LPTF_LOG_DEBUG("Erreur lors de la réception: ", strerror(errno));
         }
         return -1;
     } else if (bytes_received == 0) {
@@ -179,12 +272,52 @@ ssize_t LPTF_Socket::receive_data(std::string& data, size_t buffer_size) const {
         return 0;
     }
     
-    buffer[bytes_received] = '\0';
-    data = std::string(buffer.data(), bytes_received);
+    data.resize(bytes_received);
+    
+    return bytes_received;
+}
+
+// Réception directe dans un tampon fourni par l'appelant (pas d'allocation)
+ssize_t LPTF_Socket::receive_raw(void* buffer, size_t size) const {
+    if (socket_fd_ == -1 || !is_connected_) {
+        LPTF_LOG_WARN("Socket non connectée");
+        return -1;
+    }
+    
+    ssize_t bytes_received = recv(socket_fd_, buffer, size, 0);
+    if (bytes_received == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        LPTF_LOG_DEBUG("Erreur lors de la réception: ", strerror(errno));
+    }
     
     return bytes_received;
 }
 
+// Envoi de plusieurs tampons en un seul appel (sendmsg), sans SIGPIPE si le pair est parti
+ssize_t LPTF_Socket::send_vectored(const struct iovec* iov, int iov_count) const {
+    if (socket_fd_ == -1 || !is_connected_) {
+        LPTF_LOG_WARN("Socket non connectée");
+        return -1;
+    }
+    
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iov_count;
+    
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    
+    ssize_t bytes_sent = sendmsg(socket_fd_, &msg, flags);
+    if (bytes_sent == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        LPTF_LOG_DEBUG("Erreur lors de l'envoi: ", strerror(errno));
+    }
+    
+    return bytes_sent;
+}
+
 // Configuration du mode non-bloquant
 bool LPTF_Socket::set_non_blocking(bool non_blocking) {
     if (socket_fd_ == -1) {
@@ -193,7 +326,7 @@ bool LPTF_Socket::set_non_blocking(bool non_blocking) {
     
     int flags = fcntl(socket_fd_, F_GETFL, 0);
     if (flags == -1) {
-        std::cerr << "Erreur lors de fcntl F_GETFL: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors de fcntl F_GETFL: ", strerror(errno));
         return false;
     }
     
@@ -204,7 +337,7 @@ bool LPTF_Socket::set_non_blocking(bool non_blocking) {
     }
     
     if (fcntl(socket_fd_, F_SETFL, flags) == -1) {
-        std::cerr << "Erreur lors de fcntl F_SETFL: " << strerror(errno) << std::endl;
+        LPTF_LOG_ERROR("Erreur lors de fcntl F_SETFL: ", strerror(errno));
         return false;
     }
     
@@ -241,6 +374,62 @@ bool LPTF_Socket::is_ready_to_write() const {
     return result > 0 && (pfd.revents & POLLOUT);
 }
 
+// Envoie l'intégralité des tampons, en reprenant après les envois partiels.
+// Les iovecs sont consommées sur place (iov_base/iov_len avancent).
+bool LPTF_Socket::send_all_vectored(struct iovec* iov, int iov_count, int timeout_ms) const {
+#ifdef IOV_MAX
+    const int max_batch = IOV_MAX;
+#else
+    const int max_batch = 1024;
+#endif
+    
+    while (iov_count > 0) {
+        if (iov->iov_len == 0) {
+            ++iov;
+            --iov_count;
+            continue;
+        }
+        
+        ssize_t sent = send_vectored(iov, iov_count < max_batch ? iov_count : max_batch);
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable(timeout_ms)) {
+                continue;
+            }
+            return false;
+        }
+        
+        size_t remaining = static_cast<size_t>(sent);
+        while (iov_count > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --iov_count;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+// Attente bornée de la disponibilité en écriture
+bool LPTF_Socket::wait_writable(int timeout_ms) const {
+    if (socket_fd_ == -1) {
+        return false;
+    }
+    
+    struct pollfd pfd;
+    pfd.fd = socket_fd_;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    
+    int result = poll(&pfd, 1, timeout_ms);
+    return result > 0 && (pfd.revents & POLLOUT);
+}
+
 // Getters
 int LPTF_Socket::get_socket_fd() const {
     return socket_fd_;
@@ -271,7 +460,7 @@ void LPTF_Socket::set_address(const std::string& ip, int port) {
         address_.sin_addr.s_addr = INADDR_ANY;
     } else {
         if (inet_aton(ip.c_str(), &address_.sin_addr) == 0) {
-            std::cerr << "Adresse IP invalide: " << ip << std::endl;
+            LPTF_LOG_ERROR("Adresse IP invalide: ", ip);
         }
     }
 }
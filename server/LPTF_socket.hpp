@@ -5,6 +5,7 @@
 #include <memory>
 #include <vector>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -29,22 +30,31 @@ public:
     LPTF_Socket(LPTF_Socket&& other) noexcept;
     LPTF_Socket& operator=(LPTF_Socket&& other) noexcept;
     
-    bool create_socket();
+    bool create_socket(bool reuse_port = false);
     bool bind_socket();
     bool listen_socket(int backlog = 5);
     std::unique_ptr<LPTF_Socket> accept_connection();
+    bool accept_into(LPTF_Socket& client_socket, bool non_blocking = false);
     bool connect_to_server();
+    // Prend possession d'un descripteur déjà connecté (socketpair, descripteur hérité)
+    void attach(int fd);
    
     ssize_t send_data(const std::string& data) const;
+    ssize_t send_raw(const void* data, size_t size) const;
     ssize_t receive_data(std::string& data, size_t buffer_size = 1024) const;
+    ssize_t receive_raw(void* buffer, size_t size) const;
+    ssize_t send_vectored(const struct iovec* iov, int iov_count) const;
+    bool send_all_vectored(struct iovec* iov, int iov_count, int timeout_ms = 5000) const;
    
     bool set_non_blocking(bool non_blocking);
     bool is_ready_to_read() const;
     bool is_ready_to_write() const;
+    bool wait_writable(int timeout_ms) const;
    
     int get_socket_fd() const;
     const std::string get_ip() const;
     int get_port() const;
+    size_t format_address(char* buffer, size_t size) const;
     bool get_is_server() const;
     bool get_is_connected() const;
     
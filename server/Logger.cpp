@@ -0,0 +1,166 @@
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <errno.h>
+#include <unistd.h>
+
+void LogFormatter::append(double value) {
+    char digits[32];
+    const int count = std::snprintf(digits, sizeof(digits), "%.3f", value);
+    if (count > 0) {
+        append(std::string_view(digits, std::min(static_cast<size_t>(count), sizeof(digits) - 1)));
+    }
+}
+
+Logger::Logger()
+    : queue_(QUEUE_CAPACITY), level_(static_cast<int>(LogLevel::INFO)), running_(false), submitting_(0),
+      dropped_(0), next_thread_(0), reported_drops_(0) {
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+bool Logger::start() {
+    if (running_.exchange(true)) {
+        return true;
+    }
+    writer_ = std::thread(&Logger::writer_loop, this);
+    return true;
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    // Un appelant qui a vu running_ avant l'arrêt dépose encore son message : il
+    // est attendu, les suivants écrivent eux-mêmes. Ordre séquentiel sur running_
+    // et submitting_ : l'appelant voit l'arrêt, ou l'arrêt voit l'appelant
+    while (submitting_.load() != 0) {
+        std::this_thread::yield();
+    }
+    drain();
+}
+
+void Logger::set_level(LogLevel level) {
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::get_level() const {
+    return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+}
+
+uint64_t Logger::get_dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+const char* Logger::level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO ";
+        case LogLevel::WARN: return "WARN ";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::OFF: break;
+    }
+    return "?    ";
+}
+
+// Numéro court attribué à chaque thread à son premier message
+uint32_t Logger::thread_id() {
+    thread_local uint32_t id = next_thread_.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void Logger::submit(LogRecord& record) {
+    record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.thread = thread_id();
+
+    submitting_.fetch_add(1);
+    if (running_.load()) {
+        if (!queue_.try_push(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        submitting_.fetch_sub(1);
+        return;
+    }
+    submitting_.fetch_sub(1);
+
+    std::string line;
+    format_record(record, line);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    write_all(record.level >= LogLevel::WARN ? STDERR_FILENO : STDOUT_FILENO, line);
+}
+
+// Pas de réveil par message : le thread relit la file à intervalle fixe
+void Logger::writer_loop() {
+    while (running_.load(std::memory_order_acquire)) {
+        drain();
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                       [this] { return !running_.load(std::memory_order_acquire); });
+    }
+}
+
+void Logger::drain() {
+    std::string out;
+    std::string err;
+    LogRecord record;
+    while (queue_.try_pop(record)) {
+        format_record(record, record.level >= LogLevel::WARN ? err : out);
+    }
+
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_drops_) {
+        err += "Journal applicatif saturé : " + std::to_string(dropped - reported_drops_) + " message(s) perdu(s)\n";
+        reported_drops_ = dropped;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    write_all(STDOUT_FILENO, out);
+    write_all(STDERR_FILENO, err);
+}
+
+// HH:MM:SS.mmm NIVEAU [thread] message
+void Logger::format_record(const LogRecord& record, std::string& out) {
+    const time_t seconds = static_cast<time_t>(record.time_ns / 1000000000);
+    const int millis = static_cast<int>((record.time_ns / 1000000) % 1000);
+    struct tm local;
+    localtime_r(&seconds, &local);
+
+    char prefix[48];
+    const int size = std::snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%03d %s [%u] ", local.tm_hour,
+                                   local.tm_min, local.tm_sec, millis, level_name(record.level),
+                                   static_cast<unsigned>(record.thread));
+    out.append(prefix, size > 0 ? static_cast<size_t>(size) : 0);
+    out.append(record.text, record.length);
+    out += '\n';
+}
+
+void Logger::write_all(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        const ssize_t written = write(fd, data.data() + offset, data.size() - offset);
+        if (written == -1 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+        offset += static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include "HandoffQueue.hpp"
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+enum class LogLevel : int {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3,
+    OFF = 4
+};
+
+// Niveau minimal compilé : les appels en dessous disparaissent du binaire,
+// arguments compris (make LOG_LEVEL=0 pour garder le niveau DEBUG)
+#ifndef LPTF_LOG_LEVEL
+#define LPTF_LOG_LEVEL 1
+#endif
+
+// Message mis en forme par le thread appelant ; la date est formatée à l'écriture
+struct LogRecord {
+    static constexpr size_t MAX_TEXT = 232;
+
+    int64_t time_ns;
+    uint32_t thread;
+    LogLevel level;
+    uint16_t length;
+    char text[MAX_TEXT];
+};
+
+// Mise en forme sans allocation dans le texte d'un LogRecord, tronquée au besoin
+class LogFormatter {
+private:
+    char* buffer_;
+    size_t capacity_;
+    size_t size_;
+
+public:
+    LogFormatter(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity), size_(0) {}
+
+    size_t size() const { return size_; }
+
+    void append(std::string_view text) {
+        const size_t count = text.size() < capacity_ - size_ ? text.size() : capacity_ - size_;
+        std::memcpy(buffer_ + size_, text.data(), count);
+        size_ += count;
+    }
+    void append(const char* text) { append(std::string_view(text ? text : "(null)")); }
+    void append(const std::string& text) { append(std::string_view(text)); }
+    void append(char c) { append(std::string_view(&c, 1)); }
+    void append(bool value) { append(std::string_view(value ? "true" : "false")); }
+    void append(double value);
+
+    template<typename T>
+    std::enable_if_t<std::is_integral_v<T>> append(T value) {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+};
+
+// Journal applicatif à niveaux. Les threads appelants (reactors compris) mettent
+// le message en forme dans un enregistrement de taille fixe déposé dans une file
+// sans verrou ; un thread dédié la vide toutes les FLUSH_INTERVAL_MS et écrit
+// chaque lot en un seul write() : INFO et DEBUG sur la sortie standard, WARN et
+// ERROR sur la sortie d'erreur. File pleine : le message est compté puis perdu,
+// jamais attendu. Avant start() (ou après stop()), l'écriture est synchrone.
+class Logger {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 8192;
+    static constexpr int FLUSH_INTERVAL_MS = 10;
+
+private:
+    HandoffQueue<LogRecord> queue_;
+    std::atomic<int> level_;
+    std::atomic<bool> running_;
+    std::atomic<int> submitting_; // Appelants entre le test de running_ et leur dépôt
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint32_t> next_thread_;
+    uint64_t reported_drops_; // Pertes déjà signalées (thread d'écriture)
+    std::thread writer_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::mutex write_mutex_; // Écritures synchrones hors du thread dédié
+
+public:
+    // Forme canonique de Coplien
+    Logger();
+    Logger(const Logger& other) = delete;
+    Logger& operator=(const Logger& other) = delete;
+    ~Logger();
+
+    static Logger& instance();
+
+    bool start();
+    // Arrête le thread d'écriture puis vide la file, dépôts en cours compris
+    void stop();
+
+    void set_level(LogLevel level);
+    LogLevel get_level() const;
+    uint64_t get_dropped() const;
+
+    bool is_enabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    template<typename... Args>
+    void log(LogLevel level, const Args&... args) {
+        LogRecord record;
+        LogFormatter formatter(record.text, sizeof(record.text));
+        (formatter.append(args), ...);
+        record.length = static_cast<uint16_t>(formatter.size());
+        record.level = level;
+        submit(record);
+    }
+
+    static const char* level_name(LogLevel level);
+
+private:
+    void submit(LogRecord& record);
+    void writer_loop();
+    void drain();
+    static void format_record(const LogRecord& record, std::string& out);
+    static void write_all(int fd, const std::string& data);
+    uint32_t thread_id();
+};
+
+#define LPTF_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= LPTF_LOG_LEVEL) { \
+            if (Logger::instance().is_enabled(level)) { \
+                Logger::instance().log(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LPTF_LOG_DEBUG(...) LPTF_LOG(LogLevel::DEBUG, __VA_ARGS__)
+#define LPTF_LOG_INFO(...) LPTF_LOG(LogLevel::INFO, __VA_ARGS__)
+#define LPTF_LOG_WARN(...) LPTF_LOG(LogLevel::WARN, __VA_ARGS__)
+#define LPTF_LOG_ERROR(...) LPTF_LOG(LogLevel::ERROR, __VA_ARGS__)
+
+#endif // LOGGER_HPP
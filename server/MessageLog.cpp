@@ -0,0 +1,435 @@
+#include "MessageLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void write_be32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+static uint32_t read_be32(const uint8_t* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+static void write_be64(uint8_t* out, uint64_t value) {
+    write_be32(out, static_cast<uint32_t>(value >> 32));
+    write_be32(out + 4, static_cast<uint32_t>(value));
+}
+
+static uint64_t read_be64(const uint8_t* in) {
+    return (static_cast<uint64_t>(read_be32(in)) << 32) | read_be32(in + 4);
+}
+
+static uint64_t now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+MessageLog::MessageLog(size_t segment_size, size_t max_segments, int sync_interval_ms)
+    : segment_size_(segment_size), max_segments_(max_segments == 0 ? 1 : max_segments),
+      sync_interval_ms_(sync_interval_ms < 0 ? 0 : sync_interval_ms), active_fd_(-1), active_map_(nullptr),
+      synced_size_(0), next_seq_(1), queue_(QUEUE_CAPACITY), running_(false), signaled_(false), dropped_(0) {
+}
+
+MessageLog::~MessageLog() {
+    close();
+}
+
+bool MessageLog::open(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(segments_mutex_);
+    if (active_map_ || running_) {
+        return false;
+    }
+    if (::mkdir(directory.c_str(), 0755) == -1 && errno != EEXIST) {
+        return false;
+    }
+    directory_ = directory;
+
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        return false;
+    }
+    std::vector<uint64_t> bases;
+    while (dirent* entry = ::readdir(dir)) {
+        unsigned long long base = 0;
+        char suffix[8] = {0};
+        if (std::strlen(entry->d_name) == 24 && std::sscanf(entry->d_name, "%20llu.%3s", &base, suffix) == 2 &&
+            std::strcmp(suffix, "seg") == 0) {
+            bases.push_back(base);
+        }
+    }
+    ::closedir(dir);
+    std::sort(bases.begin(), bases.end());
+
+    segments_.clear();
+    next_seq_ = 1;
+    for (uint64_t base : bases) {
+        Segment segment{base, segment_path(directory_, base), {}, 0};
+        if (!recover_segment(segment)) {
+            return false;
+        }
+        segments_.push_back(std::move(segment));
+    }
+
+    // Le dernier segment redevient actif s'il lui reste de la place
+    if (!segments_.empty() && segments_.back().size + RECORD_HEADER_SIZE < segment_size_) {
+        if (!map_active(segments_.back())) {
+            return false;
+        }
+        // Un enregistrement tronqué par un arrêt brutal est écrasé par le suivant
+        std::memset(active_map_ + segments_.back().size, 0,
+                    std::min(RECORD_HEADER_SIZE, segment_size_ - segments_.back().size));
+    } else if (!open_segment(next_seq_)) {
+        return false;
+    }
+    enforce_retention();
+    return true;
+}
+
+bool MessageLog::start() {
+    if (!active_map_ || running_) {
+        return false;
+    }
+    running_ = true;
+    writer_ = std::thread(&MessageLog::writer_loop, this);
+    return true;
+}
+
+void MessageLog::close() {
+    if (running_.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            signaled_ = true;
+        }
+        wake_.notify_one();
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(segments_mutex_);
+    close_active();
+    segments_.clear();
+}
+
+// Le verrou n'est pris que pour réveiller un thread d'écriture endormi
+bool MessageLog::append(const std::string& room, const SharedBuffer& frames) {
+    if (!running_ || !frames || frames->empty()) {
+        return false;
+    }
+    if (!queue_.try_push(Pending{frames, room})) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (!signaled_.exchange(true)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+    return true;
+}
+
+uint64_t MessageLog::get_next_seq() const {
+    std::lock_guard<std::mutex> lock(segments_mutex_);
+    return next_seq_;
+}
+
+size_t MessageLog::get_segment_count() const {
+    std::lock_guard<std::mutex> lock(segments_mutex_);
+    return segments_.size();
+}
+
+uint64_t MessageLog::get_dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+// Tout ce qui est arrivé depuis le dernier réveil est écrit d'un bloc, puis
+// synchronisé en une fois : le coût du msync est partagé par tout le lot
+void MessageLog::writer_loop() {
+    uint64_t last_sync_ms = now_ms();
+    bool dirty = false;
+
+    while (true) {
+        const bool stopping = !running_;
+        signaled_ = false;
+
+        {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            Pending pending;
+            while (queue_.try_pop(pending)) {
+                write_frames(pending);
+                dirty = true;
+            }
+        }
+
+        const uint64_t now = now_ms();
+        if (dirty && (stopping || now - last_sync_ms >= static_cast<uint64_t>(sync_interval_ms_))) {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            sync_active();
+            last_sync_ms = now;
+            dirty = false;
+        }
+        if (stopping) {
+            break;
+        }
+
+        // Sans données en attente de synchronisation, seul un nouvel ajout réveille le thread
+        const uint64_t wait_ms = dirty ? last_sync_ms + sync_interval_ms_ - now : 1000;
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(wait_ms), [this] {
+            return signaled_.load() || !running_;
+        });
+    }
+}
+
+void MessageLog::write_frames(const Pending& pending) {
+    const std::vector<uint8_t>& buffer = *pending.frames;
+    size_t offset = 0;
+    while (offset + LPTF::LPTF_PacketView::HEADER_SIZE <= buffer.size()) {
+        const size_t frame_size = LPTF::LPTF_PacketView::HEADER_SIZE + read_be32(buffer.data() + offset + 8);
+        if (offset + frame_size > buffer.size()) {
+            break;
+        }
+        if (!write_record(pending.room, LPTF::ByteSpan(buffer.data() + offset, frame_size))) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        offset += frame_size;
+    }
+}
+
+bool MessageLog::write_record(std::string_view room, LPTF::ByteSpan frame) {
+    if (room.size() > 255) {
+        return false;
+    }
+    const size_t body = 1 + room.size() + frame.size;
+    const size_t total = RECORD_HEADER_SIZE + body;
+    if (total > segment_size_) {
+        return false;
+    }
+
+    // Rotation : le segment plein est synchronisé et tronqué avant d'ouvrir le suivant
+    if (!active_map_ || segments_.back().size + total > segment_size_) {
+        sync_active();
+        close_active();
+        if (!open_segment(next_seq_)) {
+            return false;
+        }
+        enforce_retention();
+    }
+
+    Segment& segment = segments_.back();
+    uint8_t* out = active_map_ + segment.size;
+    write_be64(out + 8, next_seq_);
+    out[RECORD_HEADER_SIZE] = static_cast<uint8_t>(room.size());
+    std::memcpy(out + RECORD_HEADER_SIZE + 1, room.data(), room.size());
+    std::memcpy(out + RECORD_HEADER_SIZE + 1 + room.size(), frame.data, frame.size);
+    write_be32(out + 4, checksum(out + 8, 8 + body));
+    write_be32(out, static_cast<uint32_t>(body));
+
+    if ((next_seq_ - segment.base_seq) % INDEX_INTERVAL == 0) {
+        segment.index.push_back({next_seq_, segment.size});
+    }
+    segment.size += total;
+    ++next_seq_;
+    return true;
+}
+
+// msync travaille par pages : la plage est alignée sur la page du dernier point synchronisé
+void MessageLog::sync_active() {
+    if (!active_map_ || segments_.empty() || segments_.back().size <= synced_size_) {
+        return;
+    }
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t start = synced_size_ - synced_size_ % page;
+    ::msync(active_map_ + start, segments_.back().size - start, MS_SYNC);
+    synced_size_ = segments_.back().size;
+}
+
+bool MessageLog::open_segment(uint64_t base_seq) {
+    segments_.push_back(Segment{base_seq, segment_path(directory_, base_seq), {}, 0});
+    if (!map_active(segments_.back())) {
+        segments_.pop_back();
+        return false;
+    }
+
+    // L'entrée du nouveau fichier dans le répertoire doit survivre à une coupure
+    const int dir_fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+bool MessageLog::map_active(const Segment& segment) {
+    const int fd = ::open(segment.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(segment_size_)) == -1) {
+        ::close(fd);
+        return false;
+    }
+    void* map = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    active_fd_ = fd;
+    active_map_ = static_cast<uint8_t*>(map);
+    synced_size_ = segment.size;
+    return true;
+}
+
+// Le fichier est ramené à sa taille utile : un segment fermé ne contient que des enregistrements
+void MessageLog::close_active() {
+    if (!active_map_) {
+        return;
+    }
+    sync_active();
+    ::munmap(active_map_, segment_size_);
+    active_map_ = nullptr;
+    if (!segments_.empty() && ::ftruncate(active_fd_, static_cast<off_t>(segments_.back().size)) == 0) {
+        ::fsync(active_fd_);
+    }
+    ::close(active_fd_);
+    active_fd_ = -1;
+    synced_size_ = 0;
+}
+
+void MessageLog::enforce_retention() {
+    while (segments_.size() > max_segments_) {
+        ::unlink(segments_.front().path.c_str());
+        segments_.erase(segments_.begin());
+    }
+}
+
+// Relit un segment existant pour reconstruire son index et retrouver sa fin
+bool MessageLog::recover_segment(Segment& segment) {
+    const int fd = ::open(segment.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+        ::close(fd);
+        return false;
+    }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    segment.size = 0;
+    if (file_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* map = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(map);
+    LogEntry entry;
+    size_t next;
+    uint64_t expected = segment.base_seq;
+    while ((next = parse_record(data, file_size, segment.size, expected, entry)) != 0) {
+        if ((entry.log_seq - segment.base_seq) % INDEX_INTERVAL == 0) {
+            segment.index.push_back({entry.log_seq, segment.size});
+        }
+        segment.size = next;
+        expected = entry.log_seq + 1;
+    }
+    ::munmap(map, file_size);
+
+    if (expected > next_seq_) {
+        next_seq_ = expected;
+    }
+    return true;
+}
+
+size_t MessageLog::find_segment(uint64_t log_seq) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), log_seq,
+                               [](uint64_t seq, const Segment& segment) { return seq < segment.base_seq; });
+    return it == segments_.begin() ? 0 : static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+MessageLog::IndexEntry MessageLog::seek(const Segment& segment, uint64_t log_seq) {
+    auto it = std::upper_bound(segment.index.begin(), segment.index.end(), log_seq,
+                               [](uint64_t seq, const IndexEntry& entry) { return seq < entry.log_seq; });
+    if (it == segment.index.begin()) {
+        return {segment.base_seq, 0};
+    }
+    return *(it - 1);
+}
+
+const uint8_t* MessageLog::map_for_reading(size_t index) const {
+    const Segment& segment = segments_[index];
+    if (index + 1 == segments_.size() && active_map_) {
+        return active_map_;
+    }
+    if (segment.size == 0) {
+        return nullptr;
+    }
+    const int fd = ::open(segment.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* map = ::mmap(nullptr, segment.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    return map == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(map);
+}
+
+void MessageLog::unmap_for_reading(size_t index, const uint8_t* data) const {
+    if (data != active_map_) {
+        ::munmap(const_cast<uint8_t*>(data), segments_[index].size);
+    }
+}
+
+size_t MessageLog::parse_record(const uint8_t* data, size_t size, size_t offset, uint64_t expected, LogEntry& entry) {
+    if (offset + RECORD_HEADER_SIZE > size) {
+        return 0;
+    }
+    const uint8_t* record = data + offset;
+    const uint32_t body = read_be32(record);
+    if (body == 0 || body > size - offset - RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    if (checksum(record + 8, 8 + body) != read_be32(record + 4)) {
+        return 0;
+    }
+    entry.log_seq = read_be64(record + 8);
+    if (expected != 0 && entry.log_seq != expected) {
+        return 0;
+    }
+    const size_t room_size = record[RECORD_HEADER_SIZE];
+    if (1 + room_size > body) {
+        return 0;
+    }
+    entry.room = std::string_view(reinterpret_cast<const char*>(record + RECORD_HEADER_SIZE + 1), room_size);
+    entry.frame = LPTF::ByteSpan(record + RECORD_HEADER_SIZE + 1 + room_size, body - 1 - room_size);
+    return offset + RECORD_HEADER_SIZE + body;
+}
+
+uint32_t MessageLog::checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::string MessageLog::segment_path(const std::string& directory, uint64_t base_seq) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.seg", static_cast<unsigned long long>(base_seq));
+    return directory + "/" + name;
+}
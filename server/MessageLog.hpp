@@ -0,0 +1,161 @@
+#ifndef MESSAGE_LOG_HPP
+#define MESSAGE_LOG_HPP
+
+#include "HandoffQueue.hpp"
+#include "WriteQueue.hpp"
+#include "../protocole/LPTF_PacketView.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Enregistrement relu depuis le journal ; les vues pointent dans le segment mappé
+struct LogEntry {
+    uint64_t log_seq;
+    std::string_view room;
+    LPTF::ByteSpan frame;
+};
+
+// Journal persistant des trames de chat, en ajout seul. Les enregistrements sont
+// écrits dans des segments de taille fixe mappés en mémoire (mmap) ; un segment
+// plein est tronqué à sa taille utile et le suivant est créé, les plus anciens
+// au-delà de la rétention sont supprimés. Un index clairsemé (une entrée tous
+// les INDEX_INTERVAL enregistrements) permet de reprendre la lecture à un numéro.
+//
+// Les reactors ne font que déposer le tampon déjà relayé dans une file sans
+// verrou ; un thread dédié écrit les lots et les synchronise ensemble sur disque
+// (group commit), au plus une fois par sync_interval_ms. File pleine : la trame
+// n'est pas journalisée plutôt que de bloquer un reactor.
+//
+// Format d'un enregistrement (ordre réseau) :
+//   [u32 taille][u32 somme FNV-1a][u64 numéro][u8 taille du salon][salon][trame]
+class MessageLog {
+public:
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_SEGMENTS = 8;
+    static constexpr int DEFAULT_SYNC_INTERVAL_MS = 10;
+    static constexpr size_t INDEX_INTERVAL = 64;
+    static constexpr size_t RECORD_HEADER_SIZE = 16;
+    static constexpr size_t QUEUE_CAPACITY = 16384;
+
+private:
+    struct IndexEntry {
+        uint64_t log_seq;
+        size_t offset;
+    };
+
+    struct Segment {
+        uint64_t base_seq;
+        std::string path;
+        std::vector<IndexEntry> index;
+        size_t size; // Octets utiles
+    };
+
+    // Trames consécutives d'un même salon, telles que relayées
+    struct Pending {
+        SharedBuffer frames;
+        std::string room;
+    };
+
+    std::string directory_;
+    size_t segment_size_;
+    size_t max_segments_;
+    int sync_interval_ms_;
+
+    // Protège les segments entre le thread d'écriture et les lecteurs
+    mutable std::mutex segments_mutex_;
+    std::vector<Segment> segments_; // Du plus ancien au segment actif
+    int active_fd_;
+    uint8_t* active_map_;
+    size_t synced_size_;
+    uint64_t next_seq_;
+
+    HandoffQueue<Pending> queue_;
+    std::thread writer_;
+    std::atomic<bool> running_;
+    std::atomic<bool> signaled_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<uint64_t> dropped_;
+
+public:
+    explicit MessageLog(size_t segment_size = DEFAULT_SEGMENT_SIZE, size_t max_segments = DEFAULT_MAX_SEGMENTS,
+                        int sync_interval_ms = DEFAULT_SYNC_INTERVAL_MS);
+    MessageLog(const MessageLog& other) = delete;
+    MessageLog& operator=(const MessageLog& other) = delete;
+    ~MessageLog();
+
+    // Crée le répertoire au besoin et relit les segments existants (index, fin du
+    // dernier segment) ; un enregistrement incomplet ou corrompu termine le journal
+    bool open(const std::string& directory);
+    bool start();
+    // Écrit ce qui reste dans la file, synchronise et ferme le segment actif
+    void close();
+
+    // Appelé par les reactors ; false si la file est pleine ou le journal arrêté
+    bool append(const std::string& room, const SharedBuffer& frames);
+
+    // Parcourt les enregistrements à partir de log_seq (ou du plus ancien conservé) ;
+    // fn(const LogEntry&) retourne false pour s'arrêter
+    template<typename Fn>
+    void for_each_from(uint64_t log_seq, Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(segments_mutex_);
+        for (size_t i = find_segment(log_seq); i < segments_.size(); ++i) {
+            const Segment& segment = segments_[i];
+            const uint8_t* data = map_for_reading(i);
+            if (!data) {
+                continue;
+            }
+            const IndexEntry start = seek(segment, log_seq);
+            size_t offset = start.offset;
+            uint64_t expected = start.log_seq;
+            bool keep_going = true;
+            LogEntry entry;
+            size_t next;
+            while ((next = parse_record(data, segment.size, offset, expected, entry)) != 0) {
+                expected = entry.log_seq + 1;
+                offset = next;
+                if (entry.log_seq >= log_seq && !fn(entry)) {
+                    keep_going = false;
+                    break;
+                }
+            }
+            unmap_for_reading(i, data);
+            if (!keep_going) {
+                return;
+            }
+        }
+    }
+
+    uint64_t get_next_seq() const;
+    size_t get_segment_count() const;
+    uint64_t get_dropped() const;
+
+private:
+    void writer_loop();
+    void write_frames(const Pending& pending);
+    bool write_record(std::string_view room, LPTF::ByteSpan frame);
+    void sync_active();
+    bool open_segment(uint64_t base_seq);
+    bool map_active(const Segment& segment);
+    void close_active();
+    void enforce_retention();
+    bool recover_segment(Segment& segment);
+
+    size_t find_segment(uint64_t log_seq) const;
+    // Dernière entrée d'index qui précède log_seq (début du segment à défaut)
+    static IndexEntry seek(const Segment& segment, uint64_t log_seq);
+    const uint8_t* map_for_reading(size_t index) const;
+    void unmap_for_reading(size_t index, const uint8_t* data) const;
+    // Décode l'enregistrement à offset ; retourne la position suivante, 0 en fin de
+    // journal (taille nulle, somme invalide, ou numéro différent de expected s'il est non nul)
+    static size_t parse_record(const uint8_t* data, size_t size, size_t offset, uint64_t expected, LogEntry& entry);
+    static uint32_t checksum(const uint8_t* data, size_t size);
+    static std::string segment_path(const std::string& directory, uint64_t base_seq);
+};
+
+#endif // MESSAGE_LOG_HPP
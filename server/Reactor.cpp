@@ -0,0 +1,309 @@
+#include "Reactor.hpp"
+#include "Logger.hpp"
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <chrono>
+
+Reactor::Reactor()
+    : epoll_fd_(-1), is_open_(false), registered_count_(0), now_ms_(0) {
+}
+
+// Une copie n'hérite pas des enregistrements : elle ouvre sa propre instance vide
+Reactor::Reactor(const Reactor& other) : Reactor() {
+    if (other.is_open_) {
+        open_reactor(other.ready_.capacity());
+    }
+}
+
+Reactor& Reactor::operator=(const Reactor& other) {
+    if (this != &other) {
+        close_reactor();
+        if (other.is_open_) {
+            open_reactor(other.ready_.capacity());
+        }
+    }
+    return *this;
+}
+
+Reactor::~Reactor() {
+    close_reactor();
+}
+
+Reactor::Reactor(Reactor&& other) noexcept : Reactor() {
+    move_from(std::move(other));
+}
+
+Reactor& Reactor::operator=(Reactor&& other) noexcept {
+    if (this != &other) {
+        close_reactor();
+        move_from(std::move(other));
+    }
+    return *this;
+}
+
+bool Reactor::open_reactor(size_t max_events) {
+    if (is_open_) {
+        return true;
+    }
+    if (max_events == 0) {
+        max_events = 1;
+    }
+
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+        LPTF_LOG_ERROR("Erreur lors de epoll_create1: ", strerror(errno));
+        return false;
+    }
+    epoll_events_.resize(max_events);
+#endif
+
+    ready_.reserve(max_events);
+    now_ms_ = clock_ms();
+    timers_.reset(now_ms_);
+    registered_count_ = 0;
+    is_open_ = true;
+    return true;
+}
+
+void Reactor::close_reactor() {
+    if (!is_open_) {
+        return;
+    }
+#ifdef __linux__
+    if (epoll_fd_ != -1) {
+        close(epoll_fd_);
+    }
+    epoll_events_.clear();
+#else
+    poll_fds_.clear();
+    poll_index_.clear();
+#endif
+    epoll_fd_ = -1;
+    is_open_ = false;
+    registered_count_ = 0;
+    ready_.clear();
+    expired_.clear();
+    timers_.reset(now_ms_);
+}
+
+int Reactor::wait_events(int max_timeout_ms) {
+    ready_.clear();
+    expired_.clear();
+    if (!is_open_) {
+        return -1;
+    }
+
+    now_ms_ = clock_ms();
+    const int count = wait_io(timers_.next_timeout(now_ms_, max_timeout_ms));
+    now_ms_ = clock_ms();
+    timers_.advance(now_ms_, expired_);
+    return count;
+}
+
+#ifdef __linux__
+
+static uint32_t to_epoll_events(uint32_t events) {
+    uint32_t result = EPOLLET | EPOLLRDHUP;
+    if (events & Reactor::READABLE) result |= EPOLLIN;
+    if (events & Reactor::WRITABLE) result |= EPOLLOUT;
+    return result;
+}
+
+bool Reactor::add_fd(int fd, uint32_t events) {
+    if (!is_open_ || fd < 0) {
+        return false;
+    }
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        LPTF_LOG_ERROR("Erreur lors de epoll_ctl ADD: ", strerror(errno));
+        return false;
+    }
+    ++registered_count_;
+    return true;
+}
+
+bool Reactor::modify_fd(int fd, uint32_t events) {
+    if (!is_open_ || fd < 0) {
+        return false;
+    }
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1) {
+        LPTF_LOG_ERROR("Erreur lors de epoll_ctl MOD: ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::remove_fd(int fd) {
+    if (!is_open_ || fd < 0) {
+        return false;
+    }
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == -1) {
+        return false;
+    }
+    --registered_count_;
+    return true;
+}
+
+int Reactor::wait_io(int timeout_ms) {
+    int count = epoll_wait(epoll_fd_, epoll_events_.data(), static_cast<int>(epoll_events_.size()), timeout_ms);
+    if (count == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const uint32_t ev = epoll_events_[i].events;
+        uint32_t events = 0;
+        if (ev & EPOLLIN) events |= READABLE;
+        if (ev & EPOLLOUT) events |= WRITABLE;
+        if (ev & (EPOLLHUP | EPOLLRDHUP)) events |= HANGUP;
+        if (ev & EPOLLERR) events |= FAILED;
+        ready_.push_back({epoll_events_[i].data.fd, events});
+    }
+    return count;
+}
+
+#else
+
+static short to_poll_events(uint32_t events) {
+    short result = 0;
+    if (events & Reactor::READABLE) result |= POLLIN;
+    if (events & Reactor::WRITABLE) result |= POLLOUT;
+    return result;
+}
+
+bool Reactor::add_fd(int fd, uint32_t events) {
+    if (!is_open_ || fd < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= poll_index_.size()) {
+        poll_index_.resize(fd + 1, -1);
+    }
+    if (poll_index_[fd] != -1) {
+        return false;
+    }
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = to_poll_events(events);
+    pfd.revents = 0;
+    poll_index_[fd] = static_cast<int>(poll_fds_.size());
+    poll_fds_.push_back(pfd);
+    ++registered_count_;
+    return true;
+}
+
+bool Reactor::modify_fd(int fd, uint32_t events) {
+    if (!is_open_ || fd < 0 || static_cast<size_t>(fd) >= poll_index_.size() || poll_index_[fd] == -1) {
+        return false;
+    }
+    poll_fds_[poll_index_[fd]].events = to_poll_events(events);
+    return true;
+}
+
+bool Reactor::remove_fd(int fd) {
+    if (!is_open_ || fd < 0 || static_cast<size_t>(fd) >= poll_index_.size() || poll_index_[fd] == -1) {
+        return false;
+    }
+    // Swap-and-pop : l'entrée retirée est remplacée par la dernière
+    const int index = poll_index_[fd];
+    const int last_fd = poll_fds_.back().fd;
+    poll_fds_[index] = poll_fds_.back();
+    poll_index_[last_fd] = index;
+    poll_fds_.pop_back();
+    poll_index_[fd] = -1;
+    --registered_count_;
+    return true;
+}
+
+int Reactor::wait_io(int timeout_ms) {
+    int result = poll(poll_fds_.data(), poll_fds_.size(), timeout_ms);
+    if (result == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (size_t i = 0; i < poll_fds_.size() && static_cast<int>(ready_.size()) < result; ++i) {
+        const short rev = poll_fds_[i].revents;
+        if (rev == 0) {
+            continue;
+        }
+        uint32_t events = 0;
+        if (rev & POLLIN) events |= READABLE;
+        if (rev & POLLOUT) events |= WRITABLE;
+        if (rev & POLLHUP) events |= HANGUP;
+        if (rev & (POLLERR | POLLNVAL)) events |= FAILED;
+        ready_.push_back({poll_fds_[i].fd, events});
+    }
+    return static_cast<int>(ready_.size());
+}
+
+#endif
+
+const std::vector<Reactor::Ready>& Reactor::get_ready() const {
+    return ready_;
+}
+
+const std::vector<TimerWheel::Expired>& Reactor::get_expired() const {
+    return expired_;
+}
+
+TimerWheel& Reactor::get_timers() {
+    return timers_;
+}
+
+uint64_t Reactor::get_now_ms() const {
+    return now_ms_;
+}
+
+uint64_t Reactor::clock_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool Reactor::is_open() const {
+    return is_open_;
+}
+
+size_t Reactor::get_registered_count() const {
+    return registered_count_;
+}
+
+void Reactor::move_from(Reactor&& other) noexcept {
+    epoll_fd_ = other.epoll_fd_;
+    is_open_ = other.is_open_;
+    registered_count_ = other.registered_count_;
+    ready_ = std::move(other.ready_);
+    timers_ = std::move(other.timers_);
+    expired_ = std::move(other.expired_);
+    now_ms_ = other.now_ms_;
+#ifdef __linux__
+    epoll_events_ = std::move(other.epoll_events_);
+#else
+    poll_fds_ = std::move(other.poll_fds_);
+    poll_index_ = std::move(other.poll_index_);
+#endif
+    other.reset();
+}
+
+void Reactor::reset() {
+    epoll_fd_ = -1;
+    is_open_ = false;
+    registered_count_ = 0;
+    ready_.clear();
+    expired_.clear();
+    timers_.reset(0);
+    now_ms_ = 0;
+#ifdef __linux__
+    epoll_events_.clear();
+#else
+    poll_fds_.clear();
+    poll_index_.clear();
+#endif
+}
@@ -0,0 +1,82 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include "TimerWheel.hpp"
+#include <vector>
+#include <cstdint>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+// Boucle d'événements persistante : les descripteurs sont enregistrés une seule
+// fois et chaque attente ne retourne que les sockets réellement prêtes.
+// Backend epoll (edge-triggered) sous Linux, poll() persistant ailleurs. Une roue
+// de temporisation intégrée borne chaque attente à la prochaine échéance ; les
+// timers échus sont rendus avec les descripteurs prêts.
+class Reactor {
+public:
+    static constexpr uint32_t READABLE = 0x01;
+    static constexpr uint32_t WRITABLE = 0x02;
+    static constexpr uint32_t HANGUP = 0x04;
+    static constexpr uint32_t FAILED = 0x08;
+
+    struct Ready {
+        int fd;
+        uint32_t events;
+    };
+
+private:
+    int epoll_fd_;
+    bool is_open_;
+    size_t registered_count_;
+    std::vector<Ready> ready_;
+    TimerWheel timers_;
+    std::vector<TimerWheel::Expired> expired_;
+    uint64_t now_ms_; // Horloge monotone relevée à la fin de la dernière attente
+#ifdef __linux__
+    std::vector<struct epoll_event> epoll_events_;
+#else
+    std::vector<struct pollfd> poll_fds_;
+    std::vector<int> poll_index_; // fd -> index dans poll_fds_ (-1 si absent)
+#endif
+
+public:
+    // Forme canonique de Coplien
+    Reactor();
+    Reactor(const Reactor& other);
+    Reactor& operator=(const Reactor& other);
+    ~Reactor();
+
+    Reactor(Reactor&& other) noexcept;
+    Reactor& operator=(Reactor&& other) noexcept;
+
+    bool open_reactor(size_t max_events = 256);
+    void close_reactor();
+
+    // Enregistrements conservés d'une itération à l'autre
+    bool add_fd(int fd, uint32_t events);
+    bool modify_fd(int fd, uint32_t events);
+    bool remove_fd(int fd);
+
+    // Attend au plus max_timeout_ms, moins si un timer échoit avant. Retourne le nombre
+    // de descripteurs prêts (get_ready()), -1 en cas d'erreur ; timers échus dans get_expired()
+    int wait_events(int max_timeout_ms);
+    const std::vector<Ready>& get_ready() const;
+    const std::vector<TimerWheel::Expired>& get_expired() const;
+    
+    // Timers armés en millisecondes sur l'horloge de get_now_ms()
+    TimerWheel& get_timers();
+    uint64_t get_now_ms() const;
+    static uint64_t clock_ms();
+
+    bool is_open() const;
+    size_t get_registered_count() const;
+
+private:
+    int wait_io(int timeout_ms);
+    void move_from(Reactor&& other) noexcept;
+    void reset();
+};
+
+#endif // REACTOR_HPP
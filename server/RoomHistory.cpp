@@ -0,0 +1,218 @@
+#include "RoomHistory.hpp"
+#include <cstring>
+
+static constexpr std::string_view SEQ_FIELD = LPTF::fields::Seq::name;
+
+RoomHistory::RoomHistory(size_t depth, size_t max_bytes, size_t max_frame_size)
+    : frames_(depth == 0 ? 1 : depth), seqs_(frames_.size(), 0), next_seq_(1), oldest_seq_(1),
+      stored_bytes_(0), max_bytes_(max_bytes), max_frame_size_(max_frame_size < max_bytes ? max_frame_size : max_bytes),
+      last_used_(0) {
+}
+
+uint64_t RoomHistory::append(const LPTF::LPTF_PacketView& frame, std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t seq = next_seq_++;
+    const size_t index = seq % frames_.size();
+    release_slot(index);
+
+    const size_t start = out.size();
+    stamp_sequence(frame, seq, out);
+    const size_t size = out.size() - start;
+    if (size <= max_frame_size_) {
+        frames_[index].assign(out.begin() + start, out.end());
+        seqs_[index] = seq;
+        stored_bytes_ += size;
+        enforce_budget();
+    }
+    return seq;
+}
+
+uint64_t RoomHistory::collect_since(uint64_t after_seq, size_t max_bytes, std::vector<uint8_t>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t depth = frames_.size();
+    const uint64_t ring_oldest = next_seq_ > depth ? next_seq_ - depth : 1;
+    const uint64_t oldest = oldest_seq_ > ring_oldest ? oldest_seq_ : ring_oldest;
+    const uint64_t first = after_seq < oldest ? oldest : after_seq + 1;
+
+    // Remontée depuis la plus récente tant que le plafond le permet ; une case
+    // peut manquer (trame trop grosse, reprise depuis un journal incomplet)
+    uint64_t begin = next_seq_;
+    size_t total = 0;
+    while (begin > first) {
+        const uint64_t seq = begin - 1;
+        if (seqs_[seq % depth] == seq) {
+            const size_t size = frames_[seq % depth].size();
+            if (total + size > max_bytes) {
+                break;
+            }
+            total += size;
+        }
+        begin = seq;
+    }
+
+    out.reserve(out.size() + total);
+    for (uint64_t seq = begin; seq < next_seq_; ++seq) {
+        if (seqs_[seq % depth] == seq) {
+            const std::vector<uint8_t>& frame = frames_[seq % depth];
+            out.insert(out.end(), frame.begin(), frame.end());
+        }
+    }
+    return next_seq_ - 1;
+}
+
+bool RoomHistory::restore(const LPTF::LPTF_PacketView& frame) {
+    uint64_t seq = 0;
+    if (!frame.get_uint64(SEQ_FIELD, seq) || seq == 0) {
+        return false;
+    }
+    const LPTF::ByteSpan bytes = frame.get_frame();
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = seq % frames_.size();
+    if (seq < oldest_seq_ || seqs_[index] >= seq) {
+        return true;
+    }
+    if (seq >= next_seq_) {
+        next_seq_ = seq + 1;
+    }
+    if (bytes.size > max_frame_size_) {
+        return true;
+    }
+    release_slot(index);
+    frames_[index].assign(bytes.data, bytes.data + bytes.size);
+    seqs_[index] = seq;
+    stored_bytes_ += bytes.size;
+    enforce_budget();
+    return true;
+}
+
+// Une grosse trame écrasée ou évincée ne laisse pas son tampon derrière elle
+void RoomHistory::release_slot(size_t index) {
+    std::vector<uint8_t>& slot = frames_[index];
+    if (seqs_[index] != 0) {
+        stored_bytes_ -= slot.size();
+        seqs_[index] = 0;
+    }
+    slot.clear();
+    if (slot.capacity() > RETAINED_CAPACITY) {
+        std::vector<uint8_t>().swap(slot);
+    }
+}
+
+// Évince les plus anciennes trames jusqu'à revenir dans le budget ; la dernière
+// conservée tient toujours seule (max_frame_size_ <= max_bytes_)
+void RoomHistory::enforce_budget() {
+    const uint64_t depth = frames_.size();
+    if (next_seq_ > depth && oldest_seq_ < next_seq_ - depth) {
+        oldest_seq_ = next_seq_ - depth;
+    }
+    while (stored_bytes_ > max_bytes_) {
+        const size_t index = oldest_seq_ % depth;
+        if (seqs_[index] == oldest_seq_) {
+            release_slot(index);
+        }
+        ++oldest_seq_;
+    }
+}
+
+uint64_t RoomHistory::get_last_seq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_seq_ - 1;
+}
+
+size_t RoomHistory::get_depth() const {
+    return frames_.size();
+}
+
+size_t RoomHistory::get_stored_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stored_bytes_;
+}
+
+void RoomHistory::touch(uint64_t tick) {
+    last_used_.store(tick, std::memory_order_relaxed);
+}
+
+uint64_t RoomHistory::get_last_used() const {
+    return last_used_.load(std::memory_order_relaxed);
+}
+
+// Les champs sont recopiés tels quels, sauf un éventuel "seq" fourni par le client
+void RoomHistory::stamp_sequence(const LPTF::LPTF_PacketView& frame, uint64_t seq, std::vector<uint8_t>& out) {
+    const LPTF::ByteSpan source = frame.get_frame();
+    const size_t start = out.size();
+    out.insert(out.end(), source.data, source.data + LPTF::LPTF_PacketView::HEADER_SIZE);
+
+    uint8_t seq_field[1 + 3 + 1 + 2 + 8];
+    seq_field[0] = static_cast<uint8_t>(SEQ_FIELD.size());
+    std::memcpy(seq_field + 1, SEQ_FIELD.data(), SEQ_FIELD.size());
+    seq_field[4] = static_cast<uint8_t>(LPTF::DataType::UINT64);
+    seq_field[5] = 0;
+    seq_field[6] = 8;
+    for (int i = 0; i < 8; ++i) {
+        seq_field[7 + i] = static_cast<uint8_t>(seq >> (56 - 8 * i));
+    }
+
+    bool inserted = false;
+    frame.for_each_field([&](const LPTF::FieldView& field) {
+        if (!inserted && field.name >= SEQ_FIELD) {
+            out.insert(out.end(), seq_field, seq_field + sizeof(seq_field));
+            inserted = true;
+        }
+        if (field.name != SEQ_FIELD) {
+            const uint8_t* begin = reinterpret_cast<const uint8_t*>(field.name.data()) - 1;
+            out.insert(out.end(), begin, field.value.data + field.value.size);
+        }
+        return true;
+    });
+    if (!inserted) {
+        out.insert(out.end(), seq_field, seq_field + sizeof(seq_field));
+    }
+
+    const uint32_t payload = static_cast<uint32_t>(out.size() - start - LPTF::LPTF_PacketView::HEADER_SIZE);
+    out[start + 8] = static_cast<uint8_t>(payload >> 24);
+    out[start + 9] = static_cast<uint8_t>(payload >> 16);
+    out[start + 10] = static_cast<uint8_t>(payload >> 8);
+    out[start + 11] = static_cast<uint8_t>(payload);
+}
+
+HistoryStore::HistoryStore(size_t depth, size_t max_rooms, size_t max_bytes, size_t max_frame_size)
+    : depth_(depth), max_rooms_(max_rooms == 0 ? 1 : max_rooms), max_bytes_(max_bytes),
+      max_frame_size_(max_frame_size), tick_(0) {
+}
+
+std::shared_ptr<RoomHistory> HistoryStore::acquire(const std::string& room) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = histories_.find(room);
+    if (it != histories_.end()) {
+        it->second->touch(++tick_);
+        return it->second;
+    }
+
+    // Création rare : le parcours pour trouver une victime reste hors du chemin des messages
+    if (histories_.size() >= max_rooms_) {
+        auto victim = histories_.end();
+        for (auto candidate = histories_.begin(); candidate != histories_.end(); ++candidate) {
+            if (candidate->second.use_count() == 1 &&
+                (victim == histories_.end() || candidate->second->get_last_used() < victim->second->get_last_used())) {
+                victim = candidate;
+            }
+        }
+        if (victim != histories_.end()) {
+            histories_.erase(victim);
+        }
+    }
+
+    auto history = std::make_shared<RoomHistory>(depth_, max_bytes_, max_frame_size_);
+    history->touch(++tick_);
+    histories_.emplace(room, history);
+    return history;
+}
+
+void HistoryStore::touch(RoomHistory& history) {
+    history.touch(++tick_);
+}
+
+size_t HistoryStore::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return histories_.size();
+}
@@ -0,0 +1,95 @@
+#ifndef ROOM_HISTORY_HPP
+#define ROOM_HISTORY_HPP
+
+#include "../protocole/LPTF_PacketView.hpp"
+#include "../protocole/LPTF_Schema.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Historique borné d'un salon : anneau des N dernières trames CHAT_MESSAGE,
+// numérotées par une séquence croissante, dans la limite d'un budget en octets
+// (les plus anciennes cèdent la place). Chaque trame relayée porte son numéro
+// dans un champ "seq" ; une trame trop grosse est numérotée mais pas conservée.
+// Un client qui revient présente le dernier numéro vu et reçoit les trames
+// manquantes en une seule écriture. Partagé entre reactors : un verrou par salon.
+class RoomHistory {
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::vector<uint8_t>> frames_; // Tampons réutilisés : mémoire fixe une fois remplis
+    std::vector<uint64_t> seqs_;               // Séquence de chaque case (0 : vide)
+    uint64_t next_seq_;
+    uint64_t oldest_seq_;                      // Plus ancienne séquence pouvant encore être présente
+    size_t stored_bytes_;
+    size_t max_bytes_;
+    size_t max_frame_size_;
+    std::atomic<uint64_t> last_used_;          // Horodatage logique pour l'éviction
+
+public:
+    static constexpr size_t DEFAULT_MAX_BYTES = 256 * 1024;
+    static constexpr size_t DEFAULT_MAX_FRAME_SIZE = 16 * 1024;
+    // Une case vidée garde son tampon jusqu'à cette capacité
+    static constexpr size_t RETAINED_CAPACITY = 4 * 1024;
+
+    explicit RoomHistory(size_t depth = 256, size_t max_bytes = DEFAULT_MAX_BYTES,
+                         size_t max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+    RoomHistory(const RoomHistory& other) = delete;
+    RoomHistory& operator=(const RoomHistory& other) = delete;
+    ~RoomHistory() = default;
+
+    // Numérote la trame, conserve sa copie estampillée et l'ajoute à out ; retourne sa séquence
+    uint64_t append(const LPTF::LPTF_PacketView& frame, std::vector<uint8_t>& out);
+
+    // Ajoute à out les trames de séquence > after_seq encore présentes, au plus
+    // max_bytes (les plus récentes d'abord retenues) ; retourne la dernière
+    // séquence attribuée, lue sous le même verrou
+    uint64_t collect_since(uint64_t after_seq, size_t max_bytes, std::vector<uint8_t>& out) const;
+
+    // Recharge une trame déjà estampillée (relue du journal) ; false sans champ "seq"
+    bool restore(const LPTF::LPTF_PacketView& frame);
+
+    uint64_t get_last_seq() const;
+    size_t get_depth() const;
+    size_t get_stored_bytes() const;
+
+    void touch(uint64_t tick);
+    uint64_t get_last_used() const;
+
+    // Copie la trame en insérant (ou remplaçant) le champ "seq", à sa place dans l'ordre des noms
+    static void stamp_sequence(const LPTF::LPTF_PacketView& frame, uint64_t seq, std::vector<uint8_t>& out);
+
+private:
+    void release_slot(size_t index);
+    void enforce_budget();
+};
+
+// Historiques de tous les salons, partagés par les reactors d'un même serveur
+class HistoryStore {
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<RoomHistory>> histories_;
+    size_t depth_;
+    size_t max_rooms_;
+    size_t max_bytes_;
+    size_t max_frame_size_;
+    std::atomic<uint64_t> tick_;
+
+public:
+    HistoryStore(size_t depth, size_t max_rooms, size_t max_bytes = RoomHistory::DEFAULT_MAX_BYTES,
+                 size_t max_frame_size = RoomHistory::DEFAULT_MAX_FRAME_SIZE);
+    HistoryStore(const HistoryStore& other) = delete;
+    HistoryStore& operator=(const HistoryStore& other) = delete;
+    ~HistoryStore() = default;
+
+    // Historique du salon, créé au besoin. Au-delà de max_rooms, le moins récemment
+    // utilisé des historiques qu'aucun reactor ne référence est abandonné
+    std::shared_ptr<RoomHistory> acquire(const std::string& room);
+    void touch(RoomHistory& history);
+    size_t size();
+};
+
+#endif // ROOM_HISTORY_HPP
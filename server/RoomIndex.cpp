@@ -0,0 +1,182 @@
+#include "RoomIndex.hpp"
+
+bool RoomIndex::is_valid_name(std::string_view name) {
+    if (name.empty() || name.size() > MAX_ROOM_NAME) {
+        return false;
+    }
+    for (char c : name) {
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RoomIndex::RoomId RoomIndex::join(ClientState& state, std::string_view name) {
+    if (!is_valid_name(name)) {
+        return INVALID_ROOM;
+    }
+    RoomId room = find(name);
+    if (room == INVALID_ROOM) {
+        room = create_room(name);
+    } else if (is_member(state, room)) {
+        return room;
+    }
+
+    std::vector<Member>& members = rooms_[room].members;
+    members.push_back({state.socket.get_socket_fd(), static_cast<uint32_t>(state.rooms.size()), state.mode,
+                       state.compression});
+    rooms_[room].compressing += state.compression ? 1 : 0;
+    state.rooms.push_back({room, static_cast<uint32_t>(members.size() - 1)});
+    return room;
+}
+
+bool RoomIndex::leave(ConnectionSlab& slab, ClientState& state, std::string_view name) {
+    const RoomId room = find(name);
+    if (room == INVALID_ROOM) {
+        return false;
+    }
+    for (size_t i = 0; i < state.rooms.size(); ++i) {
+        if (state.rooms[i].room == room) {
+            remove_membership(slab, state, i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void RoomIndex::leave_all(ConnectionSlab& slab, ClientState& state) {
+    while (!state.rooms.empty()) {
+        remove_membership(slab, state, state.rooms.size() - 1);
+    }
+}
+
+void RoomIndex::set_compression(ClientState& state, bool enabled) {
+    if (state.compression == enabled) {
+        return;
+    }
+    state.compression = enabled;
+    for (const RoomMembership& membership : state.rooms) {
+        Room& room = rooms_[membership.room];
+        room.members[membership.position].compression = enabled;
+        if (enabled) {
+            ++room.compressing;
+        } else {
+            --room.compressing;
+        }
+    }
+}
+
+RoomIndex::RoomId RoomIndex::find(std::string_view name) const {
+    auto range = ids_.equal_range(hash_name(name));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (rooms_[it->second].name == name) {
+            return it->second;
+        }
+    }
+    return INVALID_ROOM;
+}
+
+// Un client rejoint peu de salons : sa propre liste est parcourue
+bool RoomIndex::is_member(const ClientState& state, RoomId room) const {
+    for (const RoomMembership& membership : state.rooms) {
+        if (membership.room == room) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RoomIndex::get_member_count(RoomId room) const {
+    return room < rooms_.size() && rooms_[room].in_use ? rooms_[room].members.size() : 0;
+}
+
+size_t RoomIndex::get_compressing_count(RoomId room) const {
+    return room < rooms_.size() && rooms_[room].in_use ? rooms_[room].compressing : 0;
+}
+
+size_t RoomIndex::get_room_count() const {
+    return ids_.size();
+}
+
+const std::string& RoomIndex::get_name(RoomId room) const {
+    return rooms_[room].name;
+}
+
+RoomHistory* RoomIndex::get_history(RoomId room) const {
+    return room < rooms_.size() && rooms_[room].in_use ? rooms_[room].history.get() : nullptr;
+}
+
+void RoomIndex::set_history(RoomId room, std::shared_ptr<RoomHistory> history) {
+    if (room < rooms_.size() && rooms_[room].in_use) {
+        rooms_[room].history = std::move(history);
+    }
+}
+
+void RoomIndex::clear() {
+    rooms_.clear();
+    free_rooms_.clear();
+    ids_.clear();
+}
+
+size_t RoomIndex::hash_name(std::string_view name) {
+    return std::hash<std::string_view>()(name);
+}
+
+RoomIndex::RoomId RoomIndex::create_room(std::string_view name) {
+    RoomId room;
+    if (!free_rooms_.empty()) {
+        room = free_rooms_.back();
+        free_rooms_.pop_back();
+    } else {
+        room = static_cast<RoomId>(rooms_.size());
+        rooms_.push_back(Room());
+    }
+    rooms_[room].name.assign(name.data(), name.size());
+    rooms_[room].members.clear();
+    rooms_[room].compressing = 0;
+    rooms_[room].history.reset();
+    rooms_[room].in_use = true;
+    ids_.emplace(hash_name(name), room);
+    return room;
+}
+
+// Retrait en O(1) des deux côtés : le dernier abonné du salon et le dernier salon
+// du client prennent les places libérées, leurs index croisés sont mis à jour
+void RoomIndex::remove_membership(ConnectionSlab& slab, ClientState& state, size_t index) {
+    const RoomMembership membership = state.rooms[index];
+    Room& room = rooms_[membership.room];
+    if (room.members[membership.position].compression) {
+        --room.compressing;
+    }
+
+    const Member moved = room.members.back();
+    room.members[membership.position] = moved;
+    room.members.pop_back();
+    if (membership.position < room.members.size()) {
+        ClientState* other = slab.find(moved.fd);
+        if (other) {
+            other->rooms[moved.membership].position = membership.position;
+        }
+    }
+
+    const RoomMembership last = state.rooms.back();
+    state.rooms[index] = last;
+    state.rooms.pop_back();
+    if (index < state.rooms.size()) {
+        rooms_[last.room].members[last.position].membership = static_cast<uint32_t>(index);
+    }
+
+    if (room.members.empty()) {
+        auto range = ids_.equal_range(hash_name(room.name));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == membership.room) {
+                ids_.erase(it);
+                break;
+            }
+        }
+        room.history.reset();
+        room.in_use = false;
+        free_rooms_.push_back(membership.room);
+    }
+}
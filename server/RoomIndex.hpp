@@ -0,0 +1,95 @@
+#ifndef ROOM_INDEX_HPP
+#define ROOM_INDEX_HPP
+
+#include "ConnectionSlab.hpp"
+#include "RoomHistory.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Index des salons d'un reactor : chaque salon tient la liste de ses abonnés,
+// un message coûte donc O(abonnés) et non O(connexions). L'appartenance est
+// indexée des deux côtés (salon -> clients, client -> salons) pour que
+// rejoindre et quitter coûtent O(1), y compris au départ d'un client.
+class RoomIndex {
+public:
+    using RoomId = uint32_t;
+    static constexpr RoomId INVALID_ROOM = 0xFFFFFFFFu;
+    static constexpr size_t MAX_ROOM_NAME = 64;
+
+private:
+    struct Member {
+        int fd;
+        uint32_t membership; // Index dans ClientState::rooms
+        InputMode mode;      // Format du flux, fixé avant l'abonnement
+        bool compression;    // Compression négociée (tenue à jour par set_compression)
+    };
+
+    struct Room {
+        std::string name;
+        std::vector<Member> members;
+        size_t compressing;                   // Abonnés ayant négocié la compression
+        std::shared_ptr<RoomHistory> history; // Partagé avec les autres reactors
+        bool in_use;
+    };
+
+    std::vector<Room> rooms_;
+    std::vector<RoomId> free_rooms_;
+    // Clé : empreinte du nom, comparé ensuite sur place ; la recherche n'alloue rien
+    std::unordered_multimap<size_t, RoomId> ids_;
+
+public:
+    // Forme canonique de Coplien
+    RoomIndex() = default;
+    RoomIndex(const RoomIndex& other) = default;
+    RoomIndex& operator=(const RoomIndex& other) = default;
+    ~RoomIndex() = default;
+
+    RoomIndex(RoomIndex&& other) noexcept = default;
+    RoomIndex& operator=(RoomIndex&& other) noexcept = default;
+
+    static bool is_valid_name(std::string_view name);
+
+    // Salon créé au premier abonné ; INVALID_ROOM si le nom est invalide
+    RoomId join(ClientState& state, std::string_view name);
+    // false si le client n'était pas abonné ; un salon vide est supprimé
+    bool leave(ConnectionSlab& slab, ClientState& state, std::string_view name);
+    void leave_all(ConnectionSlab& slab, ClientState& state);
+    // Change la compression du client et le compte des salons qu'il a rejoints
+    void set_compression(ClientState& state, bool enabled);
+
+    RoomId find(std::string_view name) const;
+    bool is_member(const ClientState& state, RoomId room) const;
+    size_t get_member_count(RoomId room) const;
+    size_t get_compressing_count(RoomId room) const;
+    size_t get_room_count() const;
+    const std::string& get_name(RoomId room) const;
+    // nullptr tant qu'aucun historique n'est attaché ; relâché quand le salon se vide
+    RoomHistory* get_history(RoomId room) const;
+    void set_history(RoomId room, std::shared_ptr<RoomHistory> history);
+    void clear();
+
+    // Parcours des abonnés d'un salon dont le flux a le format donné ; fn reçoit
+    // le fd et la compression de l'abonné et ne doit pas modifier les abonnements
+    template<typename Fn>
+    void for_each_member(RoomId room, InputMode mode, Fn&& fn) const {
+        if (room >= rooms_.size() || !rooms_[room].in_use) {
+            return;
+        }
+        for (const Member& member : rooms_[room].members) {
+            if (member.mode == mode) {
+                fn(member.fd, member.compression);
+            }
+        }
+    }
+
+private:
+    static size_t hash_name(std::string_view name);
+    RoomId create_room(std::string_view name);
+    void remove_membership(ConnectionSlab& slab, ClientState& state, size_t index);
+};
+
+#endif // ROOM_INDEX_HPP
@@ -1,23 +1,83 @@
 #include "Server.hpp"
-#include <iostream>
-#include <algorithm>
+#include "Logger.hpp"
+#include "../protocole/LPTF_Schema.hpp"
+#include <chrono>
+#include <cstdio>
 #include <poll.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstring>
+
+
+ReactorChannel::ReactorChannel() : queue(4096), pending(false) {
+    wake_fds[0] = -1;
+    wake_fds[1] = -1;
+    if (pipe(wake_fds) == -1) {
+        LPTF_LOG_ERROR("Erreur lors de la création du pipe de réveil");
+        wake_fds[0] = -1;
+        wake_fds[1] = -1;
+        return;
+    }
+    for (int fd : wake_fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+}
+
+ReactorChannel::~ReactorChannel() {
+    for (int fd : wake_fds) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+// Un seul octet est écrit tant que le consommateur n'a pas vidé la file
+void ReactorChannel::notify() {
+    if (!pending.exchange(true, std::memory_order_acq_rel) && wake_fds[1] != -1) {
+        const char byte = 1;
+        ssize_t written = write(wake_fds[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void ReactorChannel::drain_notifications() {
+    char buffer[64];
+    while (wake_fds[0] != -1 && read(wake_fds[0], buffer, sizeof(buffer)) > 0) {
+    }
+    pending.exchange(false, std::memory_order_acq_rel);
+}
 
 
 Server::Server() 
     : server_socket_(nullptr), bind_ip_("0.0.0.0"), bind_port_(8080), 
-      is_running_(false), max_clients_(10) {
+      is_running_(false), max_clients_(10), spare_fd_(-1), overflow_policy_(OverflowPolicy::DROP_OLDEST),
+      high_watermark_(WriteQueue::DEFAULT_HIGH_WATERMARK), low_watermark_(WriteQueue::DEFAULT_LOW_WATERMARK),
+      block_timeout_ms_(100), keepalive_interval_ms_(DEFAULT_KEEPALIVE_INTERVAL_MS),
+      keepalive_timeout_ms_(DEFAULT_KEEPALIVE_TIMEOUT_MS), detect_timeout_ms_(DEFAULT_DETECT_TIMEOUT_MS),
+      write_timeout_ms_(DEFAULT_WRITE_TIMEOUT_MS),
+      compression_threshold_(LPTF::Compression::DEFAULT_THRESHOLD), compressing_clients_(0), next_stream_id_(1), reactor_count_(1), reuse_port_(false) {
 }
 
-Server::Server(const std::string& bind_ip, int bind_port, int max_clients)
+Server::Server(const std::string& bind_ip, int bind_port, int max_clients, int reactor_count)
     : server_socket_(nullptr), bind_ip_(bind_ip), bind_port_(bind_port), 
-      is_running_(false), max_clients_(max_clients) {
+      is_running_(false), max_clients_(max_clients), spare_fd_(-1), overflow_policy_(OverflowPolicy::DROP_OLDEST),
+      high_watermark_(WriteQueue::DEFAULT_HIGH_WATERMARK), low_watermark_(WriteQueue::DEFAULT_LOW_WATERMARK),
+      block_timeout_ms_(100), keepalive_interval_ms_(DEFAULT_KEEPALIVE_INTERVAL_MS),
+      keepalive_timeout_ms_(DEFAULT_KEEPALIVE_TIMEOUT_MS), detect_timeout_ms_(DEFAULT_DETECT_TIMEOUT_MS),
+      write_timeout_ms_(DEFAULT_WRITE_TIMEOUT_MS),
+      compression_threshold_(LPTF::Compression::DEFAULT_THRESHOLD), compressing_clients_(0), next_stream_id_(1), reactor_count_(reactor_count < 1 ? 1 : reactor_count), reuse_port_(false) {
 }
 
 Server::Server(const Server& other) 
     : server_socket_(nullptr), bind_ip_(""), bind_port_(0), 
-      is_running_(false), max_clients_(0) {
+      is_running_(false), max_clients_(0), spare_fd_(-1), overflow_policy_(OverflowPolicy::DROP_OLDEST),
+      high_watermark_(WriteQueue::DEFAULT_HIGH_WATERMARK), low_watermark_(WriteQueue::DEFAULT_LOW_WATERMARK),
+      block_timeout_ms_(100), keepalive_interval_ms_(DEFAULT_KEEPALIVE_INTERVAL_MS),
+      keepalive_timeout_ms_(DEFAULT_KEEPALIVE_TIMEOUT_MS), detect_timeout_ms_(DEFAULT_DETECT_TIMEOUT_MS),
+      write_timeout_ms_(DEFAULT_WRITE_TIMEOUT_MS),
+      compression_threshold_(LPTF::Compression::DEFAULT_THRESHOLD), compressing_clients_(0), next_stream_id_(1), reactor_count_(1), reuse_port_(false) {
     copy_from(other);
 }
 
@@ -31,7 +91,12 @@ Server& Server::operator=(const Server& other) {
 
 Server::Server(Server&& other) noexcept 
     : server_socket_(nullptr), bind_ip_(""), bind_port_(0), 
-      is_running_(false), max_clients_(0) {
+      is_running_(false), max_clients_(0), spare_fd_(-1), overflow_policy_(OverflowPolicy::DROP_OLDEST),
+      high_watermark_(WriteQueue::DEFAULT_HIGH_WATERMARK), low_watermark_(WriteQueue::DEFAULT_LOW_WATERMARK),
+      block_timeout_ms_(100), keepalive_interval_ms_(DEFAULT_KEEPALIVE_INTERVAL_MS),
+      keepalive_timeout_ms_(DEFAULT_KEEPALIVE_TIMEOUT_MS), detect_timeout_ms_(DEFAULT_DETECT_TIMEOUT_MS),
+      write_timeout_ms_(DEFAULT_WRITE_TIMEOUT_MS),
+      compression_threshold_(LPTF::Compression::DEFAULT_THRESHOLD), compressing_clients_(0), next_stream_id_(1), reactor_count_(1), reuse_port_(false) {
     move_from(std::move(other));
 }
 
@@ -49,36 +114,83 @@ Server::~Server() {
 
 bool Server::start_server() {
     if (is_running_) {
-        std::cout << "Le serveur est déjà en cours d'exécution" << std::endl;
+        LPTF_LOG_WARN("Le serveur est déjà en cours d'exécution");
         return true;
     }
     
     server_socket_ = std::make_unique<LPTF_Socket>(bind_ip_, bind_port_, true);
     
-    if (!server_socket_->create_socket()) {
-        std::cerr << "Erreur lors de la création de la socket serveur" << std::endl;
+    if (!server_socket_->create_socket(reuse_port_)) {
+        LPTF_LOG_ERROR("Erreur lors de la création de la socket serveur");
         return false;
     }
     
     if (!server_socket_->bind_socket()) {
-        std::cerr << "Erreur lors du bind de la socket serveur" << std::endl;
+        LPTF_LOG_ERROR("Erreur lors du bind de la socket serveur");
         return false;
     }
     
-    if (!server_socket_->listen_socket()) {
-        std::cerr << "Erreur lors de la mise en écoute de la socket serveur" << std::endl;
+    if (!server_socket_->listen_socket(LISTEN_BACKLOG)) {
+        LPTF_LOG_ERROR("Erreur lors de la mise en écoute de la socket serveur");
         return false;
     }
     
     // Configuration en mode non-bloquant pour accepter les connexions sans bloquer
     if (!server_socket_->set_non_blocking(true)) {
-        std::cerr << "Erreur lors de la configuration non-bloquante" << std::endl;
+        LPTF_LOG_ERROR("Erreur lors de la configuration non-bloquante");
+        return false;
+    }
+    
+    // Les enregistrements sont conservés d'une itération à l'autre
+    if (!reactor_.open_reactor(256) || 
+        !reactor_.add_fd(server_socket_->get_socket_fd(), Reactor::READABLE)) {
+        LPTF_LOG_ERROR("Erreur lors de l'initialisation de la boucle d'événements");
+        return false;
+    }
+    
+    // Descripteur gardé en réserve pour EMFILE/ENFILE (voir recover_accept_failure)
+    if (spare_fd_ == -1) {
+        spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+    
+    // Tous les emplacements clients sont alloués ici, plus aucun au fil des connexions ;
+    // max_clients est partagé entre les reactors (arrondi au-dessus)
+    slab_.reserve(max_clients_ > 0 ? static_cast<size_t>((max_clients_ + reactor_count_ - 1) / reactor_count_) : 0);
+    closing_clients_.reserve(slab_.capacity());
+    
+    // Trames de keepalive sérialisées une fois pour toutes les connexions
+    ping_buffer_ = make_shared_buffer(LPTF::LPTF_Packet(LPTF::MessageType::PING).serialize());
+    pong_buffer_ = make_shared_buffer(LPTF::LPTF_Packet(LPTF::MessageType::PONG).serialize());
+    ack_buffer_ = make_shared_buffer(LPTF::LPTF_Packet(LPTF::MessageType::ACK).serialize());
+    register_handlers();
+    
+    // Les reactors secondaires reçoivent celui du premier dans start_shards()
+    if (!history_) {
+        history_ = std::make_shared<HistoryStore>(HISTORY_DEPTH, MAX_HISTORY_ROOMS,
+                                                  HISTORY_ROOM_BYTES, HISTORY_FRAME_BYTES);
+    }
+    if (!total_compressing_) {
+        total_compressing_ = std::make_shared<std::atomic<size_t>>(0);
+    }
+    if (!log_ && !log_directory_.empty() && !open_message_log()) {
+        return false;
+    }
+    if (!metrics_registry_) {
+        metrics_registry_ = std::make_shared<MetricsRegistry>();
+    }
+    if (!metrics_) {
+        metrics_ = std::make_shared<ServerMetrics>();
+        metrics_registry_->add(metrics_);
+    }
+    
+    if (channel_ && !reactor_.add_fd(channel_->wake_fds[0], Reactor::READABLE)) {
+        LPTF_LOG_ERROR("Erreur lors de l'enregistrement du canal inter-reactors");
         return false;
     }
     
     is_running_ = true;
-    std::cout << "Serveur démarré sur " << bind_ip_ << ":" << bind_port_ << std::endl;
-    std::cout << "En attente de connexions clients..." << std::endl;
+    LPTF_LOG_INFO("Serveur démarré sur ", bind_ip_, ":", bind_port_);
+    LPTF_LOG_INFO("En attente de connexions clients...");
     
     return true;
 }
@@ -90,153 +202,1021 @@ void Server::stop_server() {
     
     is_running_ = false;
     
-    client_sockets_.clear();
-    client_info_.clear();
+    // Les reactors secondaires s'arrêtent à leur prochain réveil
+    for (auto& shard : shards_) {
+        shard->is_running_ = false;
+        if (shard->channel_) {
+            shard->channel_->notify();
+        }
+    }
+    
+    reactor_.close_reactor();
+    slab_.clear();
+    closing_clients_.clear();
+    rooms_.clear();
+    total_compressing_->fetch_sub(compressing_clients_, std::memory_order_relaxed);
+    compressing_clients_ = 0;
+    metrics_->connections.set(0);
+    metrics_->pending_writes.set(0);
     
     if (server_socket_) {
         server_socket_->close_socket();
         server_socket_.reset();
     }
+    if (spare_fd_ != -1) {
+        close(spare_fd_);
+        spare_fd_ = -1;
+    }
     
-    std::cout << "Serveur arrêté" << std::endl;
+    LPTF_LOG_INFO("Serveur arrêté");
 }
 
 void Server::run() {
+    if (reactor_count_ > 1) {
+        reuse_port_ = true;
+        channel_ = std::make_shared<ReactorChannel>();
+    }
+    
     if (!start_server()) {
         return;
     }
     
+    if (reactor_count_ > 1) {
+        if (!start_shards()) {
+            stop_shards();
+            stop_server();
+            return;
+        }
+        LPTF_LOG_INFO(reactor_count_, " reactors actifs (SO_REUSEPORT)");
+    }
+    
+    run_loop();
+    stop_shards();
+    
+    // Plus aucun reactor ne produit : le reste de la file est écrit et synchronisé
+    if (log_) {
+        log_->close();
+    }
+}
+
+void Server::run_loop() {
+    const int server_fd = server_socket_->get_socket_fd();
+    const int wake_fd = channel_ ? channel_->wake_fds[0] : -1;
+    
     while (is_running_) {
-        std::vector<struct pollfd> poll_fds;
-        
-        struct pollfd server_pfd;
-        server_pfd.fd = server_socket_->get_socket_fd();
-        server_pfd.events = POLLIN;
-        server_pfd.revents = 0;
-        poll_fds.push_back(server_pfd);
+        // L'attente est écourtée par la prochaine échéance de la roue de timers
+        int ready_count = reactor_.wait_events(MAX_WAIT_MS);
         
-        for (const auto& client : client_sockets_) {
-            if (client && client->get_socket_fd() != -1) {
-                struct pollfd client_pfd;
-                client_pfd.fd = client->get_socket_fd();
-                client_pfd.events = POLLIN;
-                client_pfd.revents = 0;
-                poll_fds.push_back(client_pfd);
+        if (ready_count == -1) {
+            if (is_running_) {
+                LPTF_LOG_ERROR("Erreur lors de l'attente des événements");
             }
+            break;
         }
         
-        int poll_result = poll(poll_fds.data(), poll_fds.size(), 1000);
+        // Durée de traitement de l'itération, l'attente n'est pas comptée
+        const auto iteration_start = std::chrono::steady_clock::now();
+        metrics_->wakeups.add();
+        metrics_->ready_events.record(static_cast<uint64_t>(ready_count));
         
-        if (poll_result == -1) {
-            std::cerr << "Erreur lors du poll" << std::endl;
-            break;
+        // Seules les sockets prêtes sont parcourues, retrouvées par leur fd
+        for (const Reactor::Ready& ready : reactor_.get_ready()) {
+            if (ready.fd == server_fd) {
+                handle_new_connection();
+                continue;
+            }
+            
+            if (ready.fd == wake_fd) {
+                handle_peer_messages();
+                continue;
+            }
+            
+            ClientState* state = find_state(ready.fd);
+            if (!state || state->closing) {
+                continue;
+            }
+            
+            if (ready.events & Reactor::WRITABLE) {
+                flush_client(ready.fd, *state);
+            }
+            
+            if (ready.events & (Reactor::READABLE | Reactor::HANGUP | Reactor::FAILED)) {
+                handle_client_message(state->socket);
+            }
         }
         
-        if (poll_result == 0) {
-           
+        handle_timers();
+        cleanup_disconnected_clients();
+        
+        metrics_->connections.set(slab_.size());
+        metrics_->loop_ns.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - iteration_start).count()));
+    }
+}
+
+// Seul EAGAIN vide la file d'attente : sur un autre échec, la boucle continue, sans
+// quoi les connexions restantes attendraient un nouveau front. À court de
+// descripteurs, la réserve est libérée le temps d'accepter et refermer la connexion
+bool Server::recover_accept_failure() {
+    const int error = errno;
+    if (error == EMFILE || error == ENFILE) {
+        if (spare_fd_ == -1) {
+            return false;
+        }
+        close(spare_fd_);
+        const int refused = accept(server_socket_->get_socket_fd(), nullptr, nullptr);
+        if (refused != -1) {
+            close(refused);
+            metrics_->rejected.add();
+            LPTF_LOG_WARN("Plus de descripteur disponible, connexion refusée");
+        }
+        spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return refused != -1;
+    }
+    return error == ECONNABORTED || error == EINTR || error == EPROTO;
+}
+
+void Server::handle_new_connection() {
+    // En mode edge-triggered, toutes les connexions en attente doivent être acceptées
+    while (true) {
+        ClientState* state = slab_.acquire();
+        if (!state) {
+            // Slab plein : la connexion est acceptée puis refermée aussitôt
+            LPTF_Socket refused;
+            if (!server_socket_->accept_into(refused)) {
+                if (recover_accept_failure()) {
+                    continue;
+                }
+                return;
+            }
+            metrics_->rejected.add();
+            LPTF_LOG_WARN("Nombre maximum de clients atteint, connexion refusée");
+            refused.close_socket();
             continue;
         }
         
-        if (poll_fds[0].revents & POLLIN) {
-            handle_new_connection();
+        if (!server_socket_->accept_into(state->socket, true)) {
+            slab_.release(*state);
+            if (recover_accept_failure()) {
+                continue;
+            }
+            return;
         }
         
-        for (size_t i = 1; i < poll_fds.size(); ++i) {
-            if (poll_fds[i].revents & POLLIN) {
-                int client_fd = poll_fds[i].fd;
-                auto it = std::find_if(client_sockets_.begin(), client_sockets_.end(),
-                    [client_fd](const std::unique_ptr<LPTF_Socket>& socket) {
-                        return socket && socket->get_socket_fd() == client_fd;
-                    });
-                
-                if (it != client_sockets_.end()) {
-                    handle_client_message(**it);
-                }
-            }
+        int client_fd = state->socket.get_socket_fd();
+        if (!reactor_.add_fd(client_fd, Reactor::READABLE)) {
+            slab_.release(*state);
+            continue;
         }
         
-        cleanup_disconnected_clients();
+        slab_.bind_fd(*state);
+        metrics_->accepts.add();
+        state->socket.format_address(state->address, sizeof(state->address));
+        state->output.set_watermarks(high_watermark_, low_watermark_);
+        
+        // Tant que le format n'est pas connu, le timer d'inactivité borne l'attente du premier octet
+        state->last_input_ms = reactor_.get_now_ms();
+        const int first_deadline_ms = detect_timeout_ms_ > 0 ? detect_timeout_ms_ : keepalive_interval_ms_;
+        if (first_deadline_ms > 0) {
+            arm_timer(*state, state->idle_timer, state->last_input_ms + first_deadline_ms);
+        }
+        
+        // Accueil et annonce attendent le premier octet : le format du flux n'est pas encore connu
+        LPTF_LOG_INFO("Nouveau client connecté: ", state->address, " (Total: ", slab_.size(), ")");
     }
 }
 
-
-void Server::handle_new_connection() {
-    if (static_cast<int>(client_sockets_.size()) >= max_clients_) {
-        std::cout << "Nombre maximum de clients atteint, connexion refusée" << std::endl;
+void Server::handle_client_message(LPTF_Socket& client_socket) {
+    int client_fd = client_socket.get_socket_fd();
+    ClientState* state = find_state(client_fd);
+    if (!state || state->closing) {
         return;
     }
     
-    auto new_client = server_socket_->accept_connection();
-    if (new_client) {
-        new_client->set_non_blocking(true);
-        
-        int client_fd = new_client->get_socket_fd();
-        std::string client_info = new_client->get_ip() + ":" + std::to_string(new_client->get_port());
-        
-        client_sockets_.push_back(std::move(new_client));
-        client_info_[client_fd] = client_info;
-        
-        std::cout << "Nouveau client connecté: " << client_info 
-                  << " (Total: " << client_sockets_.size() << ")" << std::endl;
+    // Le timer de keepalive n'est pas réarmé ici : il relit cette date à son échéance
+    state->last_input_ms = reactor_.get_now_ms();
+    
+    // Lecture jusqu'à EAGAIN dans le tampon de la connexion : une notification
+    // edge-triggered n'est pas répétée, et tout ce qui est arrivé part en un lot
+    bool peer_closed = false;
+    while (true) {
+        uint8_t* buffer = state->input.prepare(READ_CHUNK_SIZE);
+        ssize_t bytes_received = client_socket.receive_raw(buffer, state->input.writable_size());
         
-        std::string welcome_msg = "Bienvenue sur le serveur LPTF !";
-        client_sockets_.back()->send_data(welcome_msg);
+        if (bytes_received > 0) {
+            state->input.commit(static_cast<size_t>(bytes_received));
+            metrics_->bytes_in.add(static_cast<uint64_t>(bytes_received));
+            if (state->input.buffered_size() >= MAX_INPUT_BATCH) {
+                process_input(client_fd, *state);
+                if (state->closing) {
+                    return;
+                }
+            }
+            continue;
+        }
         
-        std::string notification = "Un nouveau client s'est connecté: " + client_info;
+        if (bytes_received == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            peer_closed = true;
+        }
+        break;
+    }
+    
+    process_input(client_fd, *state);
+    
+    if (!peer_closed) {
+        return;
+    }
+    
+    const std::string client_info = state->address;
+    
+    LPTF_LOG_INFO("Client déconnecté: ", client_info);
+    
+    // Un client parti sans rien envoyer n'avait pas été annoncé
+    if (state->mode != InputMode::DETECT) {
+        std::string notification = "Le client " + client_info + " s'est déconnecté";
         broadcast_message(notification, client_fd);
     }
+    
+    remove_client(client_fd);
 }
 
-void Server::handle_client_message(LPTF_Socket& client_socket) {
-    std::string message;
-    ssize_t bytes_received = client_socket.receive_data(message);
+// Découpe les octets accumulés en messages complets et les transmet en un lot
+void Server::process_input(int client_fd, ClientState& state) {
+    LPTF::FrameReassembler& input = state.input;
     
-    if (bytes_received > 0) {
-        int client_fd = client_socket.get_socket_fd();
-        std::string client_info = client_info_[client_fd];
+    if (state.mode == InputMode::DETECT) {
+        static const uint8_t magic[4] = {'L', 'P', 'T', 'F'};
+        const size_t available = input.buffered_size();
+        const size_t checked = available < 4 ? available : 4;
+        if (checked == 0) {
+            return;
+        }
+        if (std::memcmp(input.peek_data(), magic, checked) != 0) {
+            state.mode = InputMode::TEXT;
+        } else if (checked == 4) {
+            state.mode = InputMode::FRAMED;
+        } else {
+            return; // Début de magic : attendre la suite
+        }
+        handle_mode_detected(client_fd, state);
+        if (state.closing) {
+            return;
+        }
+    }
+    
+    input_batch_.clear();
+    
+    if (state.mode == InputMode::FRAMED) {
+        const uint8_t* frame = nullptr;
+        size_t frame_size = 0;
+        while (input.next_frame(frame, frame_size)) {
+            input_batch_.push_back(LPTF::ByteSpan(frame, frame_size));
+        }
+        if (!input_batch_.empty()) {
+            dispatch_frames(client_fd, input_batch_);
+        }
+        if (input.is_corrupted() && !state.closing) {
+            LPTF_LOG_WARN("Flux LPTF invalide de ", state.address, ", déconnexion");
+            mark_closing(client_fd, state);
+        }
+        return;
+    }
+    
+    // Mode texte : une ligne par message, le reste du lot forme le dernier message
+    const uint8_t* data = input.peek_data();
+    const size_t size = input.buffered_size();
+    size_t start = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '\n') {
+            size_t end = (i > start && data[i - 1] == '\r') ? i - 1 : i;
+            if (end > start) {
+                input_batch_.push_back(LPTF::ByteSpan(data + start, end - start));
+            }
+            start = i + 1;
+        }
+    }
+    if (start < size) {
+        input_batch_.push_back(LPTF::ByteSpan(data + start, size - start));
+    }
+    if (!input_batch_.empty()) {
+        dispatch_text(client_fd, input_batch_);
+    }
+    input.consume(size);
+}
+
+// Le format connu, le client rejoint le salon par défaut et le client texte reçoit
+// l'accueil ; l'annonce, en texte, ne va qu'aux clients texte. Un client LPTF est
+// accueilli par l'ACK de son HELLO
+void Server::handle_mode_detected(int client_fd, ClientState& state) {
+    if (keepalive_interval_ms_ > 0) {
+        arm_timer(state, state.idle_timer, state.last_input_ms + keepalive_interval_ms_);
+    } else {
+        cancel_timer(state.idle_timer);
+    }
+    join_room(state, DEFAULT_ROOM);
+    if (state.mode == InputMode::TEXT) {
+        send_to_client(client_fd, make_shared_buffer(std::string("Bienvenue sur le serveur LPTF !")));
+    }
+    broadcast_message(std::string("Un nouveau client s'est connecté: ") + state.address, client_fd);
+}
+
+void Server::dispatch_text(int client_fd, const std::vector<LPTF::ByteSpan>& messages) {
+    const ClientState* state = find_state(client_fd);
+    const std::string client_info = state ? state->address : "";
+    metrics_->text_messages.add(messages.size());
+    
+    for (const LPTF::ByteSpan& span : messages) {
+        std::string message(reinterpret_cast<const char*>(span.data), span.size);
         
-        std::cout << "Message de " << client_info << ": " << message << std::endl;
+        LPTF_LOG_DEBUG("Message de ", client_info, ": ", message);
         
-        std::string echo_msg = "[" + client_info + "]: " + message;
-        broadcast_message(echo_msg);
+        broadcast_room(DEFAULT_ROOM, make_shared_buffer("[" + client_info + "]: " + message));
+    }
+}
+
+// Chaque trame est validée sur place puis confiée au gestionnaire de son type.
+// Les trames de chat d'un même lot sont relayées telles quelles dans un seul
+// tampon partagé : un push par destinataire quel que soit leur nombre
+void Server::dispatch_frames(int client_fd, const std::vector<LPTF::ByteSpan>& frames) {
+    ClientState* state = find_state(client_fd);
+    if (!state) {
+        return;
+    }
+    
+    relay_batch_.clear();
+    for (const LPTF::ByteSpan& frame : frames) {
+        if (state->closing) {
+            break;
+        }
         
-    } else if (bytes_received == 0) {
-       
-        int client_fd = client_socket.get_socket_fd();
-        std::string client_info = client_info_[client_fd];
+        // Fragment : le message n'est traité qu'une fois reconstitué, les trames
+        // ordinaires intercalées passent entre-temps
+        if (LPTF::Fragmentation::is_fragment(frame.data, frame.size)) {
+            LPTF::ByteSpan message;
+            const LPTF::FragmentStatus status = state->fragments.add(frame.data, frame.size, message);
+            if (status == LPTF::FragmentStatus::COMPLETE) {
+                dispatch_frame(client_fd, *state, message);
+            } else if (status != LPTF::FragmentStatus::INCOMPLETE) {
+                metrics_->invalid_frames.add();
+                LPTF_LOG_WARN("Fragment rejeté de ", state->address);
+                const uint16_t raw_type = static_cast<uint16_t>((frame.data[6] << 8) | frame.data[7]);
+                if (status == LPTF::FragmentStatus::LIMIT) {
+                    send_error(client_fd, LPTF::ErrorCode::MESSAGE_TOO_LARGE, raw_type, "Message trop volumineux");
+                } else {
+                    send_error(client_fd, LPTF::ErrorCode::INVALID_PACKET, raw_type, "Fragment invalide");
+                }
+            }
+            continue;
+        }
+        dispatch_frame(client_fd, *state, frame);
+    }
+    
+    flush_relay(client_fd);
+    if (decompressed_.capacity() > RETAINED_DECOMPRESSED_SIZE) {
+        std::vector<uint8_t>().swap(decompressed_);
+    }
+}
+
+void Server::dispatch_frame(int client_fd, ClientState& state, const LPTF::ByteSpan& frame) {
+    // Trame compressée : décompressée dans un tampon du reactor si le client a
+    // négocié la compression ; sinon la vue la refuse (INVALID_PACKET)
+    LPTF::ByteSpan data = frame;
+    if (state.compression && LPTF::Compression::is_compressed(frame.data, frame.size)) {
+        decompressed_.clear();
+        if (LPTF::Compression::decompress_frame(frame.data, frame.size, decompressed_)) {
+            data = LPTF::ByteSpan(decompressed_.data(), decompressed_.size());
+        }
+    }
+    
+    LPTF::LPTF_PacketView view(data.data, data.size);
+    if (!view.is_valid()) {
+        metrics_->invalid_frames.add();
+        LPTF_LOG_WARN("Trame invalide de ", state.address);
+        const uint16_t raw_type = static_cast<uint16_t>((frame.data[6] << 8) | frame.data[7]);
+        send_error(client_fd, LPTF::ErrorCode::INVALID_PACKET, raw_type, "Trame invalide");
+        return;
+    }
+    
+    metrics_->count_frame(static_cast<uint16_t>(view.get_message_type()));
+    FrameHandler handler = handlers_.find(view.get_message_type());
+    if (!handler) {
+        send_error(client_fd, LPTF::ErrorCode::UNKNOWN_MESSAGE_TYPE,
+                   static_cast<uint16_t>(view.get_message_type()), "Type de message inconnu");
+        return;
+    }
+    (this->*handler)(client_fd, state, view);
+}
+
+// Le tampon relayé est aussi celui remis au journal : aucune copie supplémentaire.
+// Sa variante fragmentée est produite une fois pour tous les destinataires ; la
+// compressée ne l'est qu'au premier destinataire qui l'a négociée, et pas du tout
+// si aucun client ne l'a fait. Le journal garde les trames entières
+void Server::flush_relay(int client_fd) {
+    if (!relay_batch_.empty()) {
+        SharedBuffer batch = make_shared_buffer(std::move(relay_batch_));
+        if (log_) {
+            log_->append(relay_room_, batch);
+        }
+        std::shared_ptr<CompressedRelay> compressed;
+        if (compression_threshold_ > 0 && total_compressing_->load(std::memory_order_relaxed) > 0) {
+            compressed = std::make_shared<CompressedRelay>();
+            compressed->frames = batch;
+        }
+        SharedBuffer fragmented = fragment_frames(*batch);
+        const bool bulk = fragmented != nullptr;
+        if (bulk) {
+            batch = std::move(fragmented);
+        }
+        publish(relay_room_, batch, client_fd, InputMode::FRAMED, compressed, bulk);
+        relay_batch_.clear();
+    }
+}
+
+// Construite par le reactor appelant ; les autres attendent puis la partagent
+const SharedBuffer& Server::compressed_variant(CompressedRelay& relay) {
+    std::call_once(relay.built, [&]() {
+        relay.buffer = compress_frames(*relay.frames);
+        SharedBuffer fragmented = relay.buffer ? fragment_frames(*relay.buffer) : SharedBuffer();
+        if (fragmented) {
+            relay.buffer = std::move(fragmented);
+        }
+    });
+    return relay.buffer;
+}
+
+// Les salons du client et le compte partagé entre reactors suivent la négociation
+void Server::set_compression(ClientState& state, bool enabled) {
+    if (state.compression == enabled) {
+        return;
+    }
+    rooms_.set_compression(state, enabled);
+    if (enabled) {
+        ++compressing_clients_;
+        total_compressing_->fetch_add(1, std::memory_order_relaxed);
+    } else {
+        --compressing_clients_;
+        total_compressing_->fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+// Variante compressée d'une suite de trames : celles dont le payload atteint le
+// seuil sont compressées, les autres recopiées. Nul si aucune n'y gagne
+SharedBuffer Server::compress_frames(const std::vector<uint8_t>& frames) const {
+    if (compression_threshold_ == 0) {
+        return SharedBuffer();
+    }
+    
+    std::vector<uint8_t> out;
+    size_t copied = 0; // Octets de frames déjà reportés dans out
+    bool compressed = false;
+    size_t offset = 0;
+    while (frames.size() - offset >= LPTF::LPTF_PacketView::HEADER_SIZE) {
+        uint32_t payload_length;
+        std::memcpy(&payload_length, frames.data() + offset + 8, 4);
+        payload_length = LPTF::ByteOrder::ntoh32(payload_length);
+        const size_t frame_size = LPTF::LPTF_PacketView::HEADER_SIZE + payload_length;
+        if (frame_size > frames.size() - offset) {
+            break;
+        }
         
-        std::cout << "Client déconnecté: " << client_info << std::endl;
+        if (payload_length >= compression_threshold_) {
+            out.insert(out.end(), frames.begin() + copied, frames.begin() + offset);
+            copied = offset;
+            if (LPTF::Compression::compress_frame(frames.data() + offset, frame_size, out, compression_threshold_)) {
+                copied = offset + frame_size;
+                compressed = true;
+            }
+        }
+        offset += frame_size;
+    }
+    
+    if (!compressed) {
+        return SharedBuffer();
+    }
+    out.insert(out.end(), frames.begin() + copied, frames.end());
+    return make_shared_buffer(std::move(out));
+}
+
+// Variante fragmentée d'une suite de trames, nulle si aucune ne dépasse le seuil.
+// Les fragments d'un flux se suivent dans le tampon : la voie des fragments les
+// envoie dans l'ordre, sans mêler deux flux d'une même connexion
+SharedBuffer Server::fragment_frames(const std::vector<uint8_t>& frames) {
+    if (frames.size() <= LPTF::Fragmentation::DEFAULT_THRESHOLD) {
+        return SharedBuffer();
+    }
+    std::vector<uint8_t> out;
+    if (!LPTF::Fragmentation::split_frames(frames.data(), frames.size(), next_stream_id_, out)) {
+        return SharedBuffer();
+    }
+    return make_shared_buffer(std::move(out));
+}
+
+// Réponse directe à un client : compressée trame par trame s'il l'a négociée,
+// puis fragmentée si un message reste trop volumineux
+void Server::send_frames(int client_fd, ClientState& state, std::vector<uint8_t>&& frames) {
+    SharedBuffer buffer = state.compression ? compress_frames(frames) : SharedBuffer();
+    if (!buffer) {
+        buffer = make_shared_buffer(std::move(frames));
+    }
+    const SharedBuffer fragmented = fragment_frames(*buffer);
+    if (fragmented) {
+        send_to_client(client_fd, fragmented, true);
+    } else {
+        send_to_client(client_fd, buffer);
+    }
+}
+
+void Server::register_handlers() {
+    handlers_.clear();
+    handlers_.set(LPTF::MessageType::HELLO, &Server::handle_hello);
+    handlers_.set(LPTF::MessageType::CHAT_MESSAGE, &Server::handle_chat);
+    handlers_.set(LPTF::MessageType::DISCONNECT, &Server::handle_disconnect);
+    handlers_.set(LPTF::MessageType::ROOM_JOIN, &Server::handle_room_join);
+    handlers_.set(LPTF::MessageType::ROOM_LEAVE, &Server::handle_room_leave);
+    handlers_.set(LPTF::MessageType::CAPABILITY_EXCHANGE, &Server::handle_capability);
+    handlers_.set(LPTF::MessageType::STATS_REQUEST, &Server::handle_stats);
+    handlers_.set(LPTF::MessageType::PING, &Server::handle_ping);
+    handlers_.set(LPTF::MessageType::PONG, &Server::handle_ignored);
+    handlers_.set(LPTF::MessageType::ACK, &Server::handle_ignored);
+    handlers_.set(LPTF::MessageType::ERROR, &Server::handle_error);
+}
+
+// Réponse ERROR encodée directement par son schéma, sans LPTF_Packet intermédiaire
+void Server::send_error(int client_fd, LPTF::ErrorCode code, uint16_t rejected_type, const char* message) {
+    const LPTF::ErrorSchema::Values values(static_cast<uint32_t>(code), message, rejected_type);
+    send_to_client(client_fd, make_shared_buffer(LPTF::ErrorSchema::serialize(values)));
+}
+
+void Server::handle_hello(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    (void)state;
+    (void)packet;
+    send_to_client(client_fd, ack_buffer_);
+}
+
+// Les trames consécutives d'un même salon partent ensemble ; un changement de
+// salon dans le lot expédie d'abord les trames accumulées. Chaque trame est
+// numérotée et conservée dans l'historique du salon avant d'être relayée
+void Server::handle_chat(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    std::string_view room;
+    if (!packet.get_string(LPTF::fields::Room::name, room)) {
+        room = DEFAULT_ROOM;
+    }
+    const RoomIndex::RoomId room_id = rooms_.find(room);
+    if (!rooms_.is_member(state, room_id)) {
+        send_error(client_fd, LPTF::ErrorCode::NOT_IN_ROOM,
+                   static_cast<uint16_t>(LPTF::MessageType::CHAT_MESSAGE), "Salon non rejoint");
+        return;
+    }
+    
+    if (!relay_batch_.empty() && relay_room_ != room) {
+        flush_relay(client_fd);
+    }
+    relay_room_.assign(room.data(), room.size());
+    RoomHistory* history = rooms_.get_history(room_id);
+    if (history) {
+        history->append(packet, relay_batch_);
+    } else {
+        const LPTF::ByteSpan frame = packet.get_frame();
+        relay_batch_.insert(relay_batch_.end(), frame.data, frame.data + frame.size);
+    }
+}
+
+// L'ACK porte la dernière séquence du salon. Avec last_seq, les trames manquantes
+// encore dans l'historique suivent l'ACK dans le même tampon : une seule écriture
+void Server::handle_room_join(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    std::string_view room;
+    RoomIndex::RoomId room_id = RoomIndex::INVALID_ROOM;
+    if (packet.get_string(LPTF::fields::Room::name, room)) {
+        room_id = join_room(state, room);
+    }
+    if (room_id == RoomIndex::INVALID_ROOM) {
+        send_error(client_fd, LPTF::ErrorCode::INVALID_ROOM,
+                   static_cast<uint16_t>(LPTF::MessageType::ROOM_JOIN), "Nom de salon invalide");
+        return;
+    }
+    
+    RoomHistory* history = rooms_.get_history(room_id);
+    LPTF::RoomAckSchema::Values ack(std::string(room), 0);
+    const size_t ack_size = LPTF::RoomAckSchema::serialized_size(ack);
+    std::vector<uint8_t> reply(ack_size);
+    
+    uint64_t last_seq = 0;
+    if (history && packet.get_uint64(LPTF::fields::LastSeq::name, last_seq)) {
+        LPTF::RoomAckSchema::get<LPTF::fields::Seq>(ack) = history->collect_since(last_seq, HISTORY_REPLY_BYTES, reply);
+    } else if (history) {
+        LPTF::RoomAckSchema::get<LPTF::fields::Seq>(ack) = history->get_last_seq();
+    }
+    LPTF::RoomAckSchema::encode(ack, reply.data());
+    send_frames(client_fd, state, std::move(reply));
+}
+
+void Server::handle_room_leave(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    std::string_view room;
+    if (!packet.get_string(LPTF::fields::Room::name, room) || !rooms_.leave(slab_, state, room)) {
+        send_error(client_fd, LPTF::ErrorCode::NOT_IN_ROOM,
+                   static_cast<uint16_t>(LPTF::MessageType::ROOM_LEAVE), "Salon non rejoint");
+        return;
+    }
+    send_to_client(client_fd, ack_buffer_);
+}
+
+void Server::handle_disconnect(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    (void)packet;
+    LPTF_LOG_INFO("Client déconnecté: ", state.address);
+    broadcast_message(std::string("Le client ") + state.address + " s'est déconnecté", client_fd);
+    mark_closing(client_fd, state);
+}
+
+// Le serveur retient les codecs communs et annonce son seuil ; le client peut
+// envoyer des trames compressées dès la réponse reçue, et en recevoir ensuite
+void Server::handle_capability(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    uint32_t codecs = 0;
+    packet.get_uint32(LPTF::fields::Compression::name, codecs);
+    const uint32_t accepted = compression_threshold_ > 0 ? codecs & LPTF::Compression::CODEC_LZ : 0;
+    set_compression(state, accepted != 0);
+    
+    const LPTF::CapabilitySchema::Values reply(accepted, static_cast<uint32_t>(compression_threshold_));
+    send_to_client(client_fd, make_shared_buffer(LPTF::CapabilitySchema::serialize(reply)));
+}
+
+// Métriques agrégées à la demande sur tous les reactors, ou sur celui désigné
+// par le champ "reactor". Les quantiles sont des bornes de bucket (erreur < 1/8)
+void Server::handle_stats(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    uint32_t reactor = 0;
+    const MetricsSnapshot metrics = packet.get_uint32("reactor", reactor) ? get_metrics(reactor) : get_metrics();
+    
+    LPTF::LPTF_Packet reply(LPTF::MessageType::STATS_RESPONSE);
+    reply.set_uint64("reactors", metrics.reactors);
+    reply.set_uint64("accepts", metrics.accepts);
+    reply.set_uint64("rejected", metrics.rejected);
+    reply.set_uint64("disconnects", metrics.disconnects);
+    reply.set_uint64("connections", metrics.connections);
+    reply.set_uint64("pending_writes", metrics.pending_writes);
+    reply.set_uint64("bytes_in", metrics.bytes_in);
+    reply.set_uint64("bytes_out", metrics.bytes_out);
+    reply.set_uint64("text_messages", metrics.text_messages);
+    reply.set_uint64("invalid_frames", metrics.invalid_frames);
+    reply.set_uint64("wakeups", metrics.wakeups);
+    reply.set_uint64("peer_messages", metrics.peer_messages);
+    reply.set_uint64("peer_dropped", metrics.peer_dropped);
+    reply.set_uint64("queue_overflows", metrics.queue_overflows);
+    reply.set_uint64("evictions", metrics.evictions);
+    
+    const std::pair<const char*, const HistogramSnapshot*> histograms[] = {
+        {"loop_ns", &metrics.loop_ns},
+        {"ready_events", &metrics.ready_events},
+        {"queued_bytes", &metrics.queued_bytes},
+    };
+    for (const auto& histogram : histograms) {
+        const std::string prefix = histogram.first;
+        reply.set_uint64(prefix + "_count", histogram.second->count);
+        reply.set_uint64(prefix + "_mean", histogram.second->mean());
+        reply.set_uint64(prefix + "_p50", histogram.second->percentile(0.50));
+        reply.set_uint64(prefix + "_p99", histogram.second->percentile(0.99));
+        reply.set_uint64(prefix + "_p999", histogram.second->percentile(0.999));
+        reply.set_uint64(prefix + "_max", histogram.second->max);
+    }
+    
+    // Trames reçues par type : seuls les types observés figurent dans la réponse
+    for (size_t slot = 0; slot < ServerMetrics::FRAME_SLOTS; ++slot) {
+        if (metrics.frames_in[slot] == 0) {
+            continue;
+        }
+        char name[24];
+        if (slot == ServerMetrics::FRAME_SLOTS - 1) {
+            std::snprintf(name, sizeof(name), "frames_other");
+        } else {
+            std::snprintf(name, sizeof(name), "frames_%04x", static_cast<unsigned>(ServerMetrics::slot_type(slot)));
+        }
+        reply.set_uint64(name, metrics.frames_in[slot]);
+    }
+    
+    if (history_) {
+        reply.set_uint64("history_rooms", history_->size());
+    }
+    if (log_) {
+        reply.set_uint64("log_dropped", log_->get_dropped());
+        reply.set_uint64("log_next_seq", log_->get_next_seq());
+    }
+    send_frames(client_fd, state, reply.serialize());
+}
+
+void Server::handle_ping(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    (void)state;
+    (void)packet;
+    send_to_client(client_fd, pong_buffer_);
+}
+
+void Server::handle_error(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    (void)client_fd;
+    std::string_view message;
+    packet.get_string(LPTF::fields::Message::name, message);
+    LPTF_LOG_WARN("Erreur signalée par ", state.address, ": ", message);
+}
+
+// PONG et ACK : la réception suffit (activité déjà notée pour le keepalive)
+void Server::handle_ignored(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet) {
+    (void)client_fd;
+    (void)state;
+    (void)packet;
+}
+
+void Server::send_to_client(int client_fd, const SharedBuffer& buffer, bool bulk) {
+    ClientState* state = find_state(client_fd);
+    if (!state || state->closing) {
+        return;
+    }
+    
+    const bool was_empty = state->output.empty();
+    if (bulk) {
+        // Hors watermarks : un message fragmenté est remis entier ou pas du tout
+        if (!state->output.push_bulk(buffer)) {
+            metrics_->queue_overflows.add();
+            LPTF_LOG_WARN("Client lent ", state->address, ": message fragmenté abandonné");
+            return;
+        }
+    } else if (!state->output.push(buffer)) {
+        handle_overflow(client_fd, *state);
+        if (state->closing || !state->output.push(buffer)) {
+            return;
+        }
+    }
+    
+    if (was_empty) {
+        flush_client(client_fd, *state);
+    } else {
+        metrics_->queued_bytes.record(state->output.get_queued_bytes());
+    }
+    
+    if (!state->closing && state->output.is_above_high_watermark()) {
+        handle_overflow(client_fd, *state);
+    }
+}
+
+void Server::flush_client(int client_fd, ClientState& state) {
+    const ssize_t sent = state.output.flush(state.socket);
+    if (sent == -1) {
+        mark_closing(client_fd, state);
+        return;
+    }
+    if (sent > 0) {
+        state.last_output_ms = reactor_.get_now_ms();
+        metrics_->bytes_out.add(static_cast<uint64_t>(sent));
+    }
+    
+    // POLLOUT n'est demandé que tant que la file n'est pas vide
+    const bool need_write = !state.output.empty();
+    if (need_write != state.want_write) {
+        const uint32_t events = Reactor::READABLE | (need_write ? Reactor::WRITABLE : 0);
+        reactor_.modify_fd(client_fd, events);
+        state.want_write = need_write;
+        if (need_write) {
+            metrics_->pending_writes.add();
+        } else {
+            metrics_->pending_writes.sub();
+        }
         
-        std::string notification = "Le client " + client_info + " s'est déconnecté";
-        broadcast_message(notification, client_fd);
+        // Délai d'écriture compté depuis le dernier progrès de la file
+        if (!need_write) {
+            cancel_timer(state.write_timer);
+        } else if (write_timeout_ms_ > 0) {
+            state.last_output_ms = reactor_.get_now_ms();
+            arm_timer(state, state.write_timer, state.last_output_ms + write_timeout_ms_);
+        }
+    }
+}
+
+void Server::handle_overflow(int client_fd, ClientState& state) {
+    metrics_->queue_overflows.add();
+    switch (overflow_policy_) {
+        case OverflowPolicy::DROP_OLDEST: {
+            size_t dropped = state.output.drop_oldest(state.output.get_low_watermark(),
+                                                      state.output.get_max_segments() / 4);
+            if (dropped > 0) {
+                LPTF_LOG_WARN("Client lent ", state.address, ": ", dropped, " message(s) abandonné(s)");
+            }
+            break;
+        }
         
-        remove_client(client_fd);
+        case OverflowPolicy::DISCONNECT:
+            LPTF_LOG_WARN("Client lent ", state.address, " déconnecté");
+            mark_closing(client_fd, state);
+            break;
+            
+        case OverflowPolicy::BLOCK:
+            // Attente bornée : le client qui ne se vide pas à temps est déconnecté
+            while (!state.closing && !state.output.is_below_low_watermark()) {
+                if (!state.socket.wait_writable(block_timeout_ms_)) {
+                    LPTF_LOG_WARN("Client lent ", state.address, " déconnecté (timeout)");
+                    mark_closing(client_fd, state);
+                    break;
+                }
+                flush_client(client_fd, state);
+            }
+            break;
     }
 }
 
+// La connexion rejoint la liste des fermetures traitées en fin d'itération
+void Server::mark_closing(int client_fd, ClientState& state) {
+    (void)client_fd;
+    if (state.closing) {
+        return;
+    }
+    state.closing = true;
+    state.output.clear();
+    closing_clients_.push_back(slab_.get_handle(state));
+}
+
 void Server::remove_client(int client_fd) {
-   
-    client_info_.erase(client_fd);
-   
-    client_sockets_.erase(
-        std::remove_if(client_sockets_.begin(), client_sockets_.end(),
-            [client_fd](const std::unique_ptr<LPTF_Socket>& socket) {
-                return socket && socket->get_socket_fd() == client_fd;
-            }),
-        client_sockets_.end()
-    );
+    ClientState* state = find_state(client_fd);
+    if (!state) {
+        return;
+    }
+    
+    release_client(*state);
     
-    std::cout << "Client supprimé (Total: " << client_sockets_.size() << ")" << std::endl;
+    LPTF_LOG_DEBUG("Client supprimé (Total: ", slab_.size(), ")");
 }
 
 void Server::broadcast_message(const std::string& message, int sender_fd) {
-    for (const auto& client : client_sockets_) {
-        if (client && client->get_socket_fd() != -1 && client->get_socket_fd() != sender_fd) {
-            client->send_data(message);
+    broadcast_buffer(make_shared_buffer(message), sender_fd, InputMode::TEXT);
+}
+
+// Le paquet est sérialisé une seule fois, quel que soit le nombre de destinataires
+void Server::broadcast_packet(const LPTF::LPTF_Packet& packet, int sender_fd) {
+    broadcast_buffer(make_shared_buffer(packet.serialize()), sender_fd, InputMode::FRAMED);
+}
+
+void Server::broadcast_buffer(const SharedBuffer& buffer, int sender_fd, InputMode mode) {
+    publish("", buffer, sender_fd, mode);
+}
+
+void Server::broadcast_room(const std::string& room, const SharedBuffer& buffer, int sender_fd, InputMode mode) {
+    publish(room, buffer, sender_fd, mode);
+}
+
+// Texte et trames LPTF ne se mêlent jamais dans un même flux : chaque tampon
+// porte le format de ses destinataires
+void Server::publish(const std::string& room, const SharedBuffer& buffer, int sender_fd, InputMode mode,
+                     const std::shared_ptr<CompressedRelay>& compressed, bool bulk) {
+    if (room.empty()) {
+        deliver_local(buffer, sender_fd, mode);
+    } else {
+        deliver_room(room, buffer, sender_fd, mode, compressed, bulk);
+    }
+    
+    // Les autres reactors reçoivent une référence vers le même tampon immuable
+    // et le remettent à leurs propres abonnés du salon ; la variante compressée
+    // ne les suit que si l'un d'eux a des clients qui l'ont négociée
+    std::shared_ptr<CompressedRelay> peer_compressed;
+    if (compressed && total_compressing_->load(std::memory_order_relaxed) > compressing_clients_) {
+        peer_compressed = compressed;
+    }
+    for (const auto& peer : peer_channels_) {
+        if (peer->queue.try_push(PeerMessage{buffer, room, peer_compressed, bulk, mode})) {
+            peer->notify();
+        } else {
+            metrics_->peer_dropped.add();
+            LPTF_LOG_WARN("File inter-reactors pleine, message abandonné");
         }
     }
 }
 
+void Server::deliver_local(const SharedBuffer& buffer, int sender_fd, InputMode mode) {
+    slab_.for_each([&](ClientState& state) {
+        const int fd = state.socket.get_socket_fd();
+        if (fd != sender_fd && state.mode == mode) {
+            send_to_client(fd, buffer);
+        }
+    });
+}
+
+// Abonnement local, l'historique partagé du salon étant attaché à sa création
+RoomIndex::RoomId Server::join_room(ClientState& state, std::string_view room) {
+    const RoomIndex::RoomId room_id = rooms_.join(state, room);
+    if (room_id != RoomIndex::INVALID_ROOM && history_ && !rooms_.get_history(room_id)) {
+        rooms_.set_history(room_id, history_->acquire(rooms_.get_name(room_id)));
+    }
+    return room_id;
+}
+
+// Seuls les abonnés du salon au format du tampon sont parcourus
+void Server::deliver_room(const std::string& room, const SharedBuffer& buffer, int sender_fd, InputMode mode,
+                          const std::shared_ptr<CompressedRelay>& compressed, bool bulk) {
+    const RoomIndex::RoomId room_id = rooms_.find(room);
+    CompressedRelay* relay = compressed && rooms_.get_compressing_count(room_id) > 0 ? compressed.get() : nullptr;
+    rooms_.for_each_member(room_id, mode, [&](int fd, bool compression) {
+        if (fd == sender_fd) {
+            return;
+        }
+        const SharedBuffer& variant = relay && compression ? compressed_variant(*relay) : buffer;
+        send_to_client(fd, variant ? variant : buffer, bulk);
+    });
+}
+
+void Server::handle_peer_messages() {
+    channel_->drain_notifications();
+    
+    PeerMessage message;
+    while (channel_->queue.try_pop(message)) {
+        metrics_->peer_messages.add();
+        if (message.room.empty()) {
+            deliver_local(message.buffer, -1, message.mode);
+        } else {
+            deliver_room(message.room, message.buffer, -1, message.mode, message.compressed, message.bulk);
+        }
+    }
+}
+
+bool Server::start_shards() {
+    std::vector<std::shared_ptr<ReactorChannel>> channels;
+    channels.push_back(channel_);
+    
+    // Chaque reactor secondaire reprend la configuration et ouvre sa propre socket d'écoute
+    for (int i = 1; i < reactor_count_; ++i) {
+        auto shard = std::make_unique<Server>(*this);
+        shard->max_clients_ = (max_clients_ + reactor_count_ - 1) / reactor_count_;
+        shard->reactor_count_ = 1;
+        shard->reuse_port_ = true;
+        shard->channel_ = std::make_shared<ReactorChannel>();
+        shard->history_ = history_;
+        shard->total_compressing_ = total_compressing_;
+        shard->log_ = log_;
+        shard->metrics_registry_ = metrics_registry_;
+        
+        if (!shard->start_server()) {
+            return false;
+        }
+        
+        channels.push_back(shard->channel_);
+        shards_.push_back(std::move(shard));
+    }
+    
+    peer_channels_.assign(channels.begin() + 1, channels.end());
+    for (auto& shard : shards_) {
+        for (const auto& channel : channels) {
+            if (channel != shard->channel_) {
+                shard->peer_channels_.push_back(channel);
+            }
+        }
+    }
+    
+    for (auto& shard : shards_) {
+        shard_threads_.emplace_back(&Server::run_loop, shard.get());
+    }
+    
+    return true;
+}
+
+// Le journal recharge l'historique des salons avant que son thread d'écriture ne démarre
+bool Server::open_message_log() {
+    log_ = std::make_shared<MessageLog>();
+    if (!log_->open(log_directory_)) {
+        LPTF_LOG_ERROR("Impossible d'ouvrir le journal ", log_directory_);
+        log_.reset();
+        return false;
+    }
+    
+    size_t restored = 0;
+    log_->for_each_from(0, [&](const LogEntry& entry) {
+        LPTF::LPTF_PacketView view(entry.frame.data, entry.frame.size);
+        if (view.is_valid() && history_->acquire(std::string(entry.room))->restore(view)) {
+            ++restored;
+        }
+        return true;
+    });
+    
+    if (!log_->start()) {
+        log_.reset();
+        return false;
+    }
+    LPTF_LOG_INFO("Journal ", log_directory_, " : ", restored, " message(s) relu(s)");
+    return true;
+}
+
+void Server::stop_shards() {
+    for (auto& shard : shards_) {
+        shard->is_running_ = false;
+        if (shard->channel_) {
+            shard->channel_->notify();
+        }
+    }
+    
+    for (auto& thread : shard_threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    
+    shard_threads_.clear();
+    shards_.clear();
+    peer_channels_.clear();
+}
+
 const std::string& Server::get_bind_ip() const {
     return bind_ip_;
 }
@@ -254,12 +1234,28 @@ int Server::get_max_clients() const {
 }
 
 size_t Server::get_client_count() const {
-    return client_sockets_.size();
+    return slab_.size();
+}
+
+int Server::get_reactor_count() const {
+    return reactor_count_;
+}
+
+OverflowPolicy Server::get_overflow_policy() const {
+    return overflow_policy_;
+}
+
+size_t Server::get_compression_threshold() const {
+    return compression_threshold_;
+}
+
+MetricsSnapshot Server::get_metrics(size_t reactor) const {
+    return metrics_registry_ ? metrics_registry_->collect(reactor) : MetricsSnapshot();
 }
 
 void Server::set_bind_info(const std::string& ip, int port) {
     if (is_running_) {
-        std::cerr << "Impossible de changer les informations de bind pendant que le serveur fonctionne" << std::endl;
+        LPTF_LOG_WARN("Impossible de changer les informations de bind pendant que le serveur fonctionne");
         return;
     }
     
@@ -271,50 +1267,242 @@ void Server::set_max_clients(int max_clients) {
     max_clients_ = max_clients;
 }
 
+void Server::set_reactor_count(int reactor_count) {
+    if (is_running_) {
+        LPTF_LOG_WARN("Impossible de changer le nombre de reactors pendant que le serveur fonctionne");
+        return;
+    }
+    
+    reactor_count_ = reactor_count < 1 ? 1 : reactor_count;
+}
+
+void Server::set_overflow_policy(OverflowPolicy policy, int block_timeout_ms) {
+    overflow_policy_ = policy;
+    block_timeout_ms_ = block_timeout_ms;
+}
+
+void Server::set_keepalive(int interval_ms, int timeout_ms) {
+    keepalive_interval_ms_ = interval_ms < 0 ? 0 : interval_ms;
+    keepalive_timeout_ms_ = timeout_ms < 1 ? 1 : timeout_ms;
+}
+
+void Server::set_detect_timeout(int timeout_ms) {
+    detect_timeout_ms_ = timeout_ms < 0 ? 0 : timeout_ms;
+}
+
+void Server::set_write_timeout(int timeout_ms) {
+    write_timeout_ms_ = timeout_ms < 0 ? 0 : timeout_ms;
+}
+
+void Server::set_message_log(const std::string& directory) {
+    log_directory_ = directory;
+}
+
+void Server::set_compression(size_t threshold) {
+    compression_threshold_ = threshold;
+}
+
+void Server::set_write_queue_watermarks(size_t high_watermark, size_t low_watermark) {
+    high_watermark_ = high_watermark;
+    low_watermark_ = low_watermark > high_watermark ? high_watermark : low_watermark;
+}
+
 // Méthodes privées
 void Server::copy_from(const Server& other) {
     bind_ip_ = other.bind_ip_;
     bind_port_ = other.bind_port_;
     max_clients_ = other.max_clients_;
+    overflow_policy_ = other.overflow_policy_;
+    high_watermark_ = other.high_watermark_;
+    low_watermark_ = other.low_watermark_;
+    block_timeout_ms_ = other.block_timeout_ms_;
+    keepalive_interval_ms_ = other.keepalive_interval_ms_;
+    keepalive_timeout_ms_ = other.keepalive_timeout_ms_;
+    detect_timeout_ms_ = other.detect_timeout_ms_;
+    write_timeout_ms_ = other.write_timeout_ms_;
+    log_directory_ = other.log_directory_;
+    compression_threshold_ = other.compression_threshold_;
+    reactor_count_ = other.reactor_count_;
+    reuse_port_ = other.reuse_port_;
     is_running_ = false;
 }
 
 void Server::move_from(Server&& other) noexcept {
     server_socket_ = std::move(other.server_socket_);
-    client_sockets_ = std::move(other.client_sockets_);
-    client_info_ = std::move(other.client_info_);
+    slab_ = std::move(other.slab_);
+    closing_clients_ = std::move(other.closing_clients_);
+    rooms_ = std::move(other.rooms_);
+    history_ = std::move(other.history_);
+    total_compressing_ = std::move(other.total_compressing_);
+    log_directory_ = std::move(other.log_directory_);
+    log_ = std::move(other.log_);
+    metrics_ = std::move(other.metrics_);
+    metrics_registry_ = std::move(other.metrics_registry_);
+    reactor_ = std::move(other.reactor_);
     bind_ip_ = std::move(other.bind_ip_);
     bind_port_ = other.bind_port_;
-    is_running_ = other.is_running_;
+    is_running_ = other.is_running_.load();
     max_clients_ = other.max_clients_;
+    overflow_policy_ = other.overflow_policy_;
+    high_watermark_ = other.high_watermark_;
+    low_watermark_ = other.low_watermark_;
+    block_timeout_ms_ = other.block_timeout_ms_;
+    keepalive_interval_ms_ = other.keepalive_interval_ms_;
+    keepalive_timeout_ms_ = other.keepalive_timeout_ms_;
+    detect_timeout_ms_ = other.detect_timeout_ms_;
+    write_timeout_ms_ = other.write_timeout_ms_;
+    compression_threshold_ = other.compression_threshold_;
+    next_stream_id_ = other.next_stream_id_;
+    reactor_count_ = other.reactor_count_;
+    reuse_port_ = other.reuse_port_;
+    channel_ = std::move(other.channel_);
+    peer_channels_ = std::move(other.peer_channels_);
+    shards_ = std::move(other.shards_);
+    shard_threads_ = std::move(other.shard_threads_);
+    ping_buffer_ = std::move(other.ping_buffer_);
+    pong_buffer_ = std::move(other.pong_buffer_);
+    ack_buffer_ = std::move(other.ack_buffer_);
+    handlers_ = other.handlers_;
     
     other.reset();
 }
 
 void Server::reset() {
     server_socket_.reset();
-    client_sockets_.clear();
-    client_info_.clear();
+    slab_.clear();
+    closing_clients_.clear();
+    rooms_.clear();
+    history_.reset();
+    total_compressing_.reset();
+    log_.reset();
+    metrics_.reset();
+    metrics_registry_.reset();
+    reactor_.close_reactor();
     bind_ip_ = "";
     bind_port_ = 0;
     is_running_ = false;
     max_clients_ = 0;
+    reactor_count_ = 1;
+    reuse_port_ = false;
+    channel_.reset();
+    peer_channels_.clear();
+    shards_.clear();
+    shard_threads_.clear();
 }
 
+// Seules les connexions marquées pendant l'itération sont parcourues
 void Server::cleanup_disconnected_clients() {
-    client_sockets_.erase(
-        std::remove_if(client_sockets_.begin(), client_sockets_.end(),
-            [this](const std::unique_ptr<LPTF_Socket>& socket) {
-                if (!socket || socket->get_socket_fd() == -1) {
-                    return true;
-                }
-                if (!socket->get_is_connected()) {
-                    int fd = socket->get_socket_fd();
-                    client_info_.erase(fd);
-                    return true;
-                }
-                return false;
-            }),
-        client_sockets_.end()
-    );
+    for (ConnectionSlab::Handle handle : closing_clients_) {
+        ClientState* state = slab_.resolve(handle);
+        if (state && state->closing) {
+            release_client(*state);
+        }
+    }
+    closing_clients_.clear();
+}
+
+// Les timers de la connexion sont annulés avant que l'emplacement ne soit rendu
+void Server::release_client(ClientState& state) {
+    if (state.want_write) {
+        metrics_->pending_writes.sub();
+    }
+    metrics_->disconnects.add();
+    cancel_timer(state.idle_timer);
+    cancel_timer(state.write_timer);
+    rooms_.leave_all(slab_, state);
+    set_compression(state, false);
+    reactor_.remove_fd(state.socket.get_socket_fd());
+    slab_.release(state);
+}
+
+void Server::arm_timer(ClientState& state, TimerWheel::TimerId& timer, uint64_t deadline_ms) {
+    cancel_timer(timer);
+    timer = reactor_.get_timers().schedule(deadline_ms, slab_.get_handle(state));
+}
+
+void Server::cancel_timer(TimerWheel::TimerId& timer) {
+    if (timer != TimerWheel::INVALID_TIMER) {
+        reactor_.get_timers().cancel(timer);
+        timer = TimerWheel::INVALID_TIMER;
+    }
+}
+
+// Timers échus pendant la dernière attente ; un handle périmé ne résout plus rien
+void Server::handle_timers() {
+    for (const TimerWheel::Expired& expired : reactor_.get_expired()) {
+        ClientState* state = slab_.resolve(expired.user_data);
+        if (!state || state->closing) {
+            continue;
+        }
+        if (expired.id == state->idle_timer) {
+            state->idle_timer = TimerWheel::INVALID_TIMER;
+            handle_idle_timer(*state);
+        } else if (expired.id == state->write_timer) {
+            state->write_timer = TimerWheel::INVALID_TIMER;
+            handle_write_timer(*state);
+        }
+    }
+}
+
+// Silence prolongé : PING aux clients LPTF, éviction s'il reste sans réponse.
+// Le chat texte n'a pas de PING et une connexion muette depuis l'accept n'a pas
+// de format : l'une et l'autre sont fermées à l'échéance
+void Server::handle_idle_timer(ClientState& state) {
+    const uint64_t now = reactor_.get_now_ms();
+    const int client_fd = state.socket.get_socket_fd();
+    
+    if (state.mode == InputMode::DETECT) {
+        metrics_->evictions.add();
+        LPTF_LOG_WARN("Client ", state.address, " muet depuis sa connexion, déconnexion");
+        mark_closing(client_fd, state);
+        return;
+    }
+    
+    if (state.ping_sent_ms != 0 && state.last_input_ms >= state.ping_sent_ms) {
+        state.ping_sent_ms = 0;
+    }
+    if (state.ping_sent_ms != 0) {
+        metrics_->evictions.add();
+        LPTF_LOG_WARN("Client ", state.address, " sans réponse au PING, déconnexion");
+        mark_closing(client_fd, state);
+        return;
+    }
+    
+    const uint64_t idle_deadline = state.last_input_ms + keepalive_interval_ms_;
+    if (now < idle_deadline) {
+        arm_timer(state, state.idle_timer, idle_deadline);
+        return;
+    }
+    
+    if (state.mode == InputMode::FRAMED) {
+        send_to_client(client_fd, ping_buffer_);
+        state.ping_sent_ms = now;
+        arm_timer(state, state.idle_timer, now + keepalive_timeout_ms_);
+        return;
+    }
+    
+    metrics_->evictions.add();
+    LPTF_LOG_WARN("Client texte ", state.address, " inactif, déconnexion");
+    broadcast_message(std::string("Le client ") + state.address + " s'est déconnecté", client_fd);
+    mark_closing(client_fd, state);
+}
+
+void Server::handle_write_timer(ClientState& state) {
+    if (state.output.empty()) {
+        return;
+    }
+    
+    const uint64_t deadline = state.last_output_ms + write_timeout_ms_;
+    if (reactor_.get_now_ms() < deadline) {
+        arm_timer(state, state.write_timer, deadline);
+        return;
+    }
+    
+    metrics_->evictions.add();
+    LPTF_LOG_WARN("Client lent ", state.address, " déconnecté (délai d'écriture dépassé)");
+    mark_closing(state.socket.get_socket_fd(), state);
+}
+
+ClientState* Server::find_state(int client_fd) {
+    return slab_.find(client_fd);
 }
@@ -2,25 +2,148 @@
 #define SERVER_HPP
 
 #include "LPTF_socket.hpp"
+#include "Reactor.hpp"
+#include "HandoffQueue.hpp"
+#include "WriteQueue.hpp"
+#include "ConnectionSlab.hpp"
+#include "RoomIndex.hpp"
+#include "MessageLog.hpp"
+#include "ServerMetrics.hpp"
+#include "../protocole/LPTF_Protocol.hpp"
+#include "../protocole/LPTF_Framing.hpp"
+#include "../protocole/LPTF_PacketView.hpp"
+#include "../protocole/LPTF_Dispatch.hpp"
+#include "../protocole/LPTF_Compression.hpp"
+#include "../protocole/LPTF_Fragment.hpp"
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
-#include <map>
+#include <atomic>
+#include <thread>
+
+// Variante compressée d'un lot relayé, construite au plus une fois, par le premier
+// reactor qui trouve parmi ses destinataires un client l'ayant négociée
+struct CompressedRelay {
+    SharedBuffer frames;  // Trames entières du lot
+    std::once_flag built;
+    SharedBuffer buffer;  // Nul si aucune trame n'y gagne
+};
+
+// Message transmis entre reactors : tampon partagé et salon destinataire
+struct PeerMessage {
+    SharedBuffer buffer;
+    std::string room;        // Vide : tous les clients
+    std::shared_ptr<CompressedRelay> compressed; // Nul si aucun client du reactor ne l'a négociée
+    bool bulk;               // Trames fragmentées : voie des fragments de la file d'envoi
+    InputMode mode;          // Destinataires : clients texte ou clients LPTF
+};
+
+// Canal entre reactors : file sans verrou + pipe de réveil enregistré dans le Reactor
+struct ReactorChannel {
+    HandoffQueue<PeerMessage> queue;
+    std::atomic<bool> pending;
+    int wake_fds[2];
+    
+    ReactorChannel();
+    ReactorChannel(const ReactorChannel& other) = delete;
+    ReactorChannel& operator=(const ReactorChannel& other) = delete;
+    ~ReactorChannel();
+    
+    void notify();
+    void drain_notifications();
+};
 
 class Server {
+public:
+    // Gestionnaire d'une trame LPTF validée, reçue de la connexion state
+    using FrameHandler = void (Server::*)(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+
 private:
     std::unique_ptr<LPTF_Socket> server_socket_;
-    std::vector<std::unique_ptr<LPTF_Socket>> client_sockets_;
-    std::map<int, std::string> client_info_; // fd -> info client
+    ConnectionSlab slab_; // Connexions clientes, allouées une fois au démarrage
+    std::vector<ConnectionSlab::Handle> closing_clients_; // Fermetures différées de l'itération
+    RoomIndex rooms_; // Abonnés locaux de chaque salon
+    std::shared_ptr<HistoryStore> history_; // Historiques des salons, communs à tous les reactors
+    std::string log_directory_;             // Vide : pas de journal sur disque
+    std::shared_ptr<MessageLog> log_;       // Un seul thread d'écriture pour tous les reactors
+    std::shared_ptr<ServerMetrics> metrics_;            // Écrites par le seul thread de ce reactor
+    std::shared_ptr<MetricsRegistry> metrics_registry_; // Métriques de tous les reactors
+    Reactor reactor_;
     std::string bind_ip_;
     int bind_port_;
-    bool is_running_;
+    std::atomic<bool> is_running_;
     int max_clients_;
+    int spare_fd_; // Réserve libérée pour refuser une connexion à court de descripteurs
+    
+    // Contre-pression : budget de la file d'envoi de chaque client
+    OverflowPolicy overflow_policy_;
+    size_t high_watermark_;
+    size_t low_watermark_;
+    int block_timeout_ms_;
+    
+    // Temporisations par connexion, portées par la roue du Reactor (0 = désactivé)
+    int keepalive_interval_ms_; // Silence avant l'envoi d'un PING
+    int keepalive_timeout_ms_;  // Délai de réponse au PING avant éviction
+    int detect_timeout_ms_;     // Délai accordé au premier octet avant fermeture
+    int write_timeout_ms_;      // Durée maximale sans progrès d'une file d'envoi non vide
+    SharedBuffer ping_buffer_;
+    SharedBuffer pong_buffer_;
+    SharedBuffer ack_buffer_;
+    
+    // Table de saut des trames LPTF, remplie au démarrage par register_handlers()
+    LPTF::DispatchTable<FrameHandler> handlers_;
+    std::vector<uint8_t> relay_batch_; // Trames de chat du lot en cours
+    std::string relay_room_;           // Salon de ces trames
+    
+    // Compression négociée par connexion : payload minimal compressé (0 = refusée)
+    size_t compression_threshold_;
+    size_t compressing_clients_; // Clients de ce reactor l'ayant négociée
+    std::shared_ptr<std::atomic<size_t>> total_compressing_; // Tous reactors confondus
+    std::vector<uint8_t> decompressed_; // Trame entrante décompressée, réutilisée
+    
+    // Messages sortants au-delà de Fragmentation::DEFAULT_THRESHOLD : un flux chacun
+    uint32_t next_stream_id_;
+    
+    // Mode multi-reactors : chaque reactor possède sa socket d'écoute (SO_REUSEPORT)
+    int reactor_count_;
+    bool reuse_port_;
+    std::shared_ptr<ReactorChannel> channel_;
+    std::vector<std::shared_ptr<ReactorChannel>> peer_channels_;
+    std::vector<std::unique_ptr<Server>> shards_;
+    std::vector<std::thread> shard_threads_;
+    
+    // Messages extraits lors d'un réveil, transmis en un seul lot
+    std::vector<LPTF::ByteSpan> input_batch_;
 
 public:
+    static constexpr size_t READ_CHUNK_SIZE = 16 * 1024;
+    // Au-delà, les messages déjà reçus sont traités avant de continuer à lire
+    static constexpr size_t MAX_INPUT_BATCH = 256 * 1024;
+    // Au-delà, le tampon de décompression est libéré après le lot plutôt que conservé
+    static constexpr size_t RETAINED_DECOMPRESSED_SIZE = 1024 * 1024;
+    // Salon rejoint dès le format du flux connu ; chat texte et trames sans champ "room"
+    static constexpr const char* DEFAULT_ROOM = "lobby";
+    // Trames CHAT_MESSAGE conservées par salon, et nombre de salons dotés d'un historique
+    static constexpr size_t HISTORY_DEPTH = 256;
+    static constexpr size_t MAX_HISTORY_ROOMS = 1024;
+    // Budget d'un salon, plus grosse trame conservée, et plafond du rattrapage envoyé
+    // à un ROOM_JOIN (sous le seuil bas de la file d'envoi)
+    static constexpr size_t HISTORY_ROOM_BYTES = 256 * 1024;
+    static constexpr size_t HISTORY_FRAME_BYTES = 16 * 1024;
+    static constexpr size_t HISTORY_REPLY_BYTES = 64 * 1024;
+    static constexpr int DEFAULT_KEEPALIVE_INTERVAL_MS = 30000;
+    static constexpr int DEFAULT_KEEPALIVE_TIMEOUT_MS = 10000;
+    static constexpr int DEFAULT_DETECT_TIMEOUT_MS = 10000;
+    static constexpr int DEFAULT_WRITE_TIMEOUT_MS = 30000;
+    // Attente maximale du Reactor, pour relire is_running_
+    static constexpr int MAX_WAIT_MS = 1000;
+    // File des connexions en attente d'accept() ; plafonnée par net.core.somaxconn
+    static constexpr int LISTEN_BACKLOG = 4096;
+    
     // Forme canonique de Coplien
     Server();
-    Server(const std::string& bind_ip, int bind_port, int max_clients = 10);
+    Server(const std::string& bind_ip, int bind_port, int max_clients = 10, int reactor_count = 1);
     Server(const Server& other);
     Server& operator=(const Server& other);
     ~Server();
@@ -39,6 +162,11 @@ public:
     void handle_client_message(LPTF_Socket& client_socket);
     void remove_client(int client_fd);
     void broadcast_message(const std::string& message, int sender_fd = -1);
+    void broadcast_packet(const LPTF::LPTF_Packet& packet, int sender_fd = -1);
+    // Le tampon n'est remis qu'aux clients du format mode (texte ou trames LPTF)
+    void broadcast_buffer(const SharedBuffer& buffer, int sender_fd = -1, InputMode mode = InputMode::TEXT);
+    void broadcast_room(const std::string& room, const SharedBuffer& buffer, int sender_fd = -1,
+                        InputMode mode = InputMode::TEXT);
     
     // Getters (const)
     const std::string& get_bind_ip() const;
@@ -46,16 +174,78 @@ public:
     bool get_is_running() const;
     int get_max_clients() const;
     size_t get_client_count() const;
+    int get_reactor_count() const;
+    OverflowPolicy get_overflow_policy() const;
+    size_t get_compression_threshold() const;
+    // Somme des métriques de tous les reactors, ou d'un seul ; lisible depuis tout thread
+    MetricsSnapshot get_metrics(size_t reactor = SIZE_MAX) const;
     
     // Setters
     void set_bind_info(const std::string& ip, int port);
     void set_max_clients(int max_clients);
+    void set_reactor_count(int reactor_count);
+    void set_overflow_policy(OverflowPolicy policy, int block_timeout_ms = 100);
+    void set_write_queue_watermarks(size_t high_watermark, size_t low_watermark);
+    void set_keepalive(int interval_ms, int timeout_ms);
+    void set_detect_timeout(int timeout_ms);
+    void set_write_timeout(int timeout_ms);
+    void set_message_log(const std::string& directory);
+    // Seuil proposé aux clients qui demandent la compression ; 0 la refuse
+    void set_compression(size_t threshold);
 
 private:
     void copy_from(const Server& other);
     void move_from(Server&& other) noexcept;
     void reset();
+    bool recover_accept_failure();
     void cleanup_disconnected_clients();
+    void run_loop();
+    bool start_shards();
+    void stop_shards();
+    bool open_message_log();
+    void publish(const std::string& room, const SharedBuffer& buffer, int sender_fd, InputMode mode,
+                 const std::shared_ptr<CompressedRelay>& compressed = nullptr, bool bulk = false);
+    void deliver_local(const SharedBuffer& buffer, int sender_fd, InputMode mode);
+    void deliver_room(const std::string& room, const SharedBuffer& buffer, int sender_fd, InputMode mode,
+                      const std::shared_ptr<CompressedRelay>& compressed = nullptr, bool bulk = false);
+    SharedBuffer compress_frames(const std::vector<uint8_t>& frames) const;
+    const SharedBuffer& compressed_variant(CompressedRelay& relay);
+    void set_compression(ClientState& state, bool enabled);
+    SharedBuffer fragment_frames(const std::vector<uint8_t>& frames);
+    void send_frames(int client_fd, ClientState& state, std::vector<uint8_t>&& frames);
+    RoomIndex::RoomId join_room(ClientState& state, std::string_view room);
+    void handle_peer_messages();
+    ClientState* find_state(int client_fd);
+    void send_to_client(int client_fd, const SharedBuffer& buffer, bool bulk = false);
+    void flush_client(int client_fd, ClientState& state);
+    void handle_overflow(int client_fd, ClientState& state);
+    void mark_closing(int client_fd, ClientState& state);
+    void release_client(ClientState& state);
+    void arm_timer(ClientState& state, TimerWheel::TimerId& timer, uint64_t deadline_ms);
+    void cancel_timer(TimerWheel::TimerId& timer);
+    void handle_timers();
+    void handle_idle_timer(ClientState& state);
+    void handle_write_timer(ClientState& state);
+    void process_input(int client_fd, ClientState& state);
+    void handle_mode_detected(int client_fd, ClientState& state);
+    void dispatch_text(int client_fd, const std::vector<LPTF::ByteSpan>& messages);
+    void dispatch_frames(int client_fd, const std::vector<LPTF::ByteSpan>& frames);
+    void dispatch_frame(int client_fd, ClientState& state, const LPTF::ByteSpan& frame);
+    void register_handlers();
+    void flush_relay(int client_fd);
+    void send_error(int client_fd, LPTF::ErrorCode code, uint16_t rejected_type, const char* message);
+    
+    // Gestionnaires de trames
+    void handle_hello(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_chat(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_room_join(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_room_leave(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_disconnect(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_capability(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_stats(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_ping(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_error(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
+    void handle_ignored(int client_fd, ClientState& state, const LPTF::LPTF_PacketView& packet);
 };
 
 #endif // SERVER_HPP
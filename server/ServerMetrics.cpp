@@ -0,0 +1,104 @@
+#include "ServerMetrics.hpp"
+
+void HistogramSnapshot::merge(const MetricHistogram& histogram) {
+    for (size_t i = 0; i < MetricHistogram::BUCKET_COUNT; ++i) {
+        buckets[i] += histogram.buckets_[i].get();
+    }
+    count += histogram.count_.get();
+    sum += histogram.sum_.get();
+    const uint64_t other_max = histogram.max_.get();
+    if (other_max > max) {
+        max = other_max;
+    }
+}
+
+// Les buckets sont lus un à un pendant que le reactor écrit : leur somme peut
+// différer légèrement de count, d'où le rang calculé sur la somme relue
+uint64_t HistogramSnapshot::percentile(double quantile) const {
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total) + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            const uint64_t bound = MetricHistogram::bucket_upper_bound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+uint64_t HistogramSnapshot::mean() const {
+    return count == 0 ? 0 : sum / count;
+}
+
+uint16_t ServerMetrics::slot_type(size_t slot) {
+    using Table = LPTF::DispatchTable<int>;
+    if (slot < Table::SYSTEM_SLOT) {
+        return static_cast<uint16_t>(slot);
+    }
+    return static_cast<uint16_t>(Table::SYSTEM_BASE + (slot - Table::SYSTEM_SLOT));
+}
+
+MetricsSnapshot::MetricsSnapshot()
+    : reactors(0), accepts(0), rejected(0), disconnects(0), bytes_in(0), bytes_out(0),
+      text_messages(0), invalid_frames(0), wakeups(0), peer_messages(0), peer_dropped(0),
+      queue_overflows(0), evictions(0), connections(0), pending_writes(0),
+      frames_in(ServerMetrics::FRAME_SLOTS, 0) {
+}
+
+void MetricsSnapshot::merge(const ServerMetrics& metrics) {
+    ++reactors;
+    accepts += metrics.accepts.get();
+    rejected += metrics.rejected.get();
+    disconnects += metrics.disconnects.get();
+    bytes_in += metrics.bytes_in.get();
+    bytes_out += metrics.bytes_out.get();
+    text_messages += metrics.text_messages.get();
+    invalid_frames += metrics.invalid_frames.get();
+    wakeups += metrics.wakeups.get();
+    peer_messages += metrics.peer_messages.get();
+    peer_dropped += metrics.peer_dropped.get();
+    queue_overflows += metrics.queue_overflows.get();
+    evictions += metrics.evictions.get();
+    connections += metrics.connections.get();
+    pending_writes += metrics.pending_writes.get();
+    for (size_t i = 0; i < ServerMetrics::FRAME_SLOTS; ++i) {
+        frames_in[i] += metrics.frames_in[i].get();
+    }
+    loop_ns.merge(metrics.loop_ns);
+    ready_events.merge(metrics.ready_events);
+    queued_bytes.merge(metrics.queued_bytes);
+}
+
+size_t MetricsRegistry::add(std::shared_ptr<ServerMetrics> metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reactors_.push_back(std::move(metrics));
+    return reactors_.size() - 1;
+}
+
+size_t MetricsRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reactors_.size();
+}
+
+MetricsSnapshot MetricsRegistry::collect(size_t reactor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot snapshot;
+    for (size_t i = 0; i < reactors_.size(); ++i) {
+        if (reactor >= reactors_.size() || reactor == i) {
+            snapshot.merge(*reactors_[i]);
+        }
+    }
+    return snapshot;
+}
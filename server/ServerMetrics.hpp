@@ -0,0 +1,189 @@
+#ifndef SERVER_METRICS_HPP
+#define SERVER_METRICS_HPP
+
+#include "../protocole/LPTF_Dispatch.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Compteur à écrivain unique : seul le thread de son reactor l'incrémente, par
+// un chargement et un stockage relâchés (aucune instruction verrouillée). Les
+// autres threads le lisent à tout moment sans verrou.
+class MetricCounter {
+private:
+    std::atomic<uint64_t> value_;
+
+public:
+    // Forme canonique de Coplien
+    MetricCounter() : value_(0) {}
+    MetricCounter(const MetricCounter& other) = delete;
+    MetricCounter& operator=(const MetricCounter& other) = delete;
+    ~MetricCounter() = default;
+
+    void add(uint64_t amount = 1) {
+        value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    void sub(uint64_t amount = 1) {
+        value_.store(value_.load(std::memory_order_relaxed) - amount, std::memory_order_relaxed);
+    }
+    void set(uint64_t value) { value_.store(value, std::memory_order_relaxed); }
+    uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// Histogramme log-linéaire : SUB_BUCKETS intervalles par puissance de deux,
+// soit une erreur relative inférieure à 1/SUB_BUCKETS sur les quantiles.
+// Les valeurs inférieures à SUB_BUCKETS sont exactes.
+class MetricHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+private:
+    std::array<MetricCounter, BUCKET_COUNT> buckets_;
+    MetricCounter count_;
+    MetricCounter sum_;
+    MetricCounter max_;
+
+public:
+    // Forme canonique de Coplien
+    MetricHistogram() = default;
+    MetricHistogram(const MetricHistogram& other) = delete;
+    MetricHistogram& operator=(const MetricHistogram& other) = delete;
+    ~MetricHistogram() = default;
+
+    void record(uint64_t value) {
+        buckets_[bucket_of(value)].add();
+        count_.add();
+        sum_.add(value);
+        if (value > max_.get()) {
+            max_.set(value);
+        }
+    }
+
+    static size_t bucket_of(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        const uint64_t sub = (value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    // Plus grande valeur rangée dans le bucket
+    static uint64_t bucket_upper_bound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        const unsigned exponent = static_cast<unsigned>(bucket / SUB_BUCKETS) + SUB_BITS - 1;
+        const uint64_t sub = bucket % SUB_BUCKETS;
+        const uint64_t lower = (SUB_BUCKETS + sub) << (exponent - SUB_BITS);
+        return lower + (uint64_t(1) << (exponent - SUB_BITS)) - 1;
+    }
+
+    friend struct HistogramSnapshot;
+};
+
+// Copie figée d'un ou plusieurs histogrammes, additionnables entre reactors
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+
+    HistogramSnapshot() : buckets(MetricHistogram::BUCKET_COUNT, 0), count(0), sum(0), max(0) {}
+
+    void merge(const MetricHistogram& histogram);
+    // Borne supérieure du bucket qui contient le quantile (0 < quantile <= 1)
+    uint64_t percentile(double quantile) const;
+    uint64_t mean() const;
+};
+
+// Métriques d'un reactor. Alignées sur une ligne de cache pour que les
+// reactors voisins n'invalident pas mutuellement leurs compteurs.
+struct alignas(64) ServerMetrics {
+    // Trames par type, indexées comme la table de dispatch ; dernière entrée :
+    // types hors table
+    static constexpr size_t FRAME_SLOTS = LPTF::DispatchTable<int>::TABLE_SIZE + 1;
+
+    MetricCounter accepts;
+    MetricCounter rejected;         // Slab plein
+    MetricCounter disconnects;
+    MetricCounter bytes_in;
+    MetricCounter bytes_out;
+    MetricCounter text_messages;
+    MetricCounter invalid_frames;
+    MetricCounter wakeups;          // Retours de wait_events()
+    MetricCounter peer_messages;    // Reçus des autres reactors
+    MetricCounter peer_dropped;     // File inter-reactors pleine
+    MetricCounter queue_overflows;  // Dépassements du budget d'une file d'envoi
+    MetricCounter evictions;        // Keepalive ou délai d'écriture dépassé
+    MetricCounter connections;      // Jauge : connexions ouvertes
+    MetricCounter pending_writes;   // Jauge : connexions en attente de POLLOUT
+    std::array<MetricCounter, FRAME_SLOTS> frames_in;
+
+    MetricHistogram loop_ns;        // Traitement d'une itération, attente exclue
+    MetricHistogram ready_events;   // Événements par réveil
+    MetricHistogram queued_bytes;   // File d'envoi d'un client après un ajout en attente
+
+    void count_frame(uint16_t type) {
+        const int index = LPTF::DispatchTable<int>::index_of(type);
+        frames_in[index < 0 ? FRAME_SLOTS - 1 : static_cast<size_t>(index)].add();
+    }
+
+    // Type de message d'une entrée de frames_in (la dernière n'en a pas)
+    static uint16_t slot_type(size_t slot);
+};
+
+// Somme des métriques d'un ensemble de reactors, calculée à la demande
+struct MetricsSnapshot {
+    uint64_t reactors;
+    uint64_t accepts;
+    uint64_t rejected;
+    uint64_t disconnects;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t text_messages;
+    uint64_t invalid_frames;
+    uint64_t wakeups;
+    uint64_t peer_messages;
+    uint64_t peer_dropped;
+    uint64_t queue_overflows;
+    uint64_t evictions;
+    uint64_t connections;
+    uint64_t pending_writes;
+    std::vector<uint64_t> frames_in;
+    HistogramSnapshot loop_ns;
+    HistogramSnapshot ready_events;
+    HistogramSnapshot queued_bytes;
+
+    MetricsSnapshot();
+
+    void merge(const ServerMetrics& metrics);
+};
+
+// Métriques de tous les reactors d'un serveur. L'enregistrement n'a lieu qu'au
+// démarrage ; collect() peut être appelé depuis n'importe quel reactor.
+class MetricsRegistry {
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<ServerMetrics>> reactors_;
+
+public:
+    // Forme canonique de Coplien
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry& other) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry& other) = delete;
+    ~MetricsRegistry() = default;
+
+    // Retourne l'indice du reactor
+    size_t add(std::shared_ptr<ServerMetrics> metrics);
+    size_t size() const;
+    // Tous les reactors ; un seul si reactor est un indice valide
+    MetricsSnapshot collect(size_t reactor = SIZE_MAX) const;
+};
+
+#endif // SERVER_METRICS_HPP
@@ -0,0 +1,258 @@
+#include "TimerWheel.hpp"
+#include <utility>
+
+static constexpr uint32_t NIL = TimerWheel::INVALID_TIMER;
+
+TimerWheel::TimerWheel() {
+    reset(0);
+}
+
+TimerWheel::TimerWheel(const TimerWheel& other) {
+    reset(other.start_ms_);
+    current_tick_ = other.current_tick_;
+}
+
+TimerWheel& TimerWheel::operator=(const TimerWheel& other) {
+    if (this != &other) {
+        reset(other.start_ms_);
+        current_tick_ = other.current_tick_;
+    }
+    return *this;
+}
+
+TimerWheel::TimerWheel(TimerWheel&& other) noexcept
+    : nodes_(std::move(other.nodes_)), free_nodes_(std::move(other.free_nodes_)),
+      retired_(std::move(other.retired_)), start_ms_(other.start_ms_),
+      current_tick_(other.current_tick_), count_(other.count_) {
+    for (unsigned i = 0; i < LEVELS * SLOTS; ++i) {
+        heads_[i] = other.heads_[i];
+    }
+    for (unsigned i = 0; i < LEVELS; ++i) {
+        occupied_[i] = other.occupied_[i];
+    }
+    other.reset(other.start_ms_);
+}
+
+TimerWheel& TimerWheel::operator=(TimerWheel&& other) noexcept {
+    if (this != &other) {
+        nodes_ = std::move(other.nodes_);
+        free_nodes_ = std::move(other.free_nodes_);
+        retired_ = std::move(other.retired_);
+        start_ms_ = other.start_ms_;
+        current_tick_ = other.current_tick_;
+        count_ = other.count_;
+        for (unsigned i = 0; i < LEVELS * SLOTS; ++i) {
+            heads_[i] = other.heads_[i];
+        }
+        for (unsigned i = 0; i < LEVELS; ++i) {
+            occupied_[i] = other.occupied_[i];
+        }
+        other.reset(other.start_ms_);
+    }
+    return *this;
+}
+
+void TimerWheel::reset(uint64_t now_ms) {
+    nodes_.clear();
+    free_nodes_.clear();
+    retired_.clear();
+    for (unsigned i = 0; i < LEVELS * SLOTS; ++i) {
+        heads_[i] = NIL;
+    }
+    for (unsigned i = 0; i < LEVELS; ++i) {
+        occupied_[i] = 0;
+    }
+    start_ms_ = now_ms;
+    current_tick_ = 0;
+    count_ = 0;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t deadline_ms, uint64_t user_data) {
+    const uint32_t index = allocate_node();
+    Node& node = nodes_[index];
+    const uint64_t tick = to_tick(deadline_ms);
+    node.deadline_tick = tick > current_tick_ ? tick : current_tick_ + 1;
+    node.user_data = user_data;
+    node.active = true;
+    link(index);
+    ++count_;
+    return index;
+}
+
+void TimerWheel::cancel(TimerId id) {
+    if (id >= nodes_.size() || !nodes_[id].active) {
+        return;
+    }
+    unlink(id);
+    nodes_[id].active = false;
+    free_nodes_.push_back(id);
+    --count_;
+}
+
+size_t TimerWheel::advance(uint64_t now_ms, std::vector<Expired>& expired) {
+    // Les identifiants rendus au tour précédent ne sont réutilisés qu'à présent :
+    // l'appelant a pu les comparer aux siens sans ambiguïté
+    free_nodes_.insert(free_nodes_.end(), retired_.begin(), retired_.end());
+    retired_.clear();
+
+    const uint64_t target = now_ms > start_ms_ ? (now_ms - start_ms_) / TICK_MS : 0;
+    size_t fired = 0;
+
+    while (current_tick_ < target) {
+        if (count_ == 0) {
+            current_tick_ = target;
+            break;
+        }
+        // Niveau 0 vide : saut direct à la prochaine frontière de 64 ticks
+        if (occupied_[0] == 0) {
+            const uint64_t boundary = ((current_tick_ >> SLOT_BITS) + 1) << SLOT_BITS;
+            if (boundary > target) {
+                current_tick_ = target;
+                break;
+            }
+            current_tick_ = boundary - 1;
+        }
+
+        ++current_tick_;
+        for (unsigned level = LEVELS - 1; level > 0; --level) {
+            // Descente d'un niveau quand tous les niveaux inférieurs ont bouclé
+            if ((current_tick_ & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+
+        const unsigned slot = static_cast<unsigned>(current_tick_ & (SLOTS - 1));
+        uint32_t index = heads_[slot];
+        heads_[slot] = NIL;
+        occupied_[0] &= ~(uint64_t(1) << slot);
+        while (index != NIL) {
+            Node& node = nodes_[index];
+            const uint32_t next = node.next;
+            node.active = false;
+            expired.push_back({index, node.user_data});
+            retired_.push_back(index);
+            --count_;
+            ++fired;
+            index = next;
+        }
+    }
+    return fired;
+}
+
+static uint64_t rotate_right(uint64_t value, unsigned shift) {
+    return shift == 0 ? value : (value >> shift) | (value << (64 - shift));
+}
+
+int TimerWheel::next_timeout(uint64_t now_ms, int max_timeout_ms) const {
+    if (count_ == 0) {
+        return max_timeout_ms;
+    }
+
+    uint64_t next_tick = UINT64_MAX;
+    for (unsigned level = 0; level < LEVELS; ++level) {
+        if (occupied_[level] == 0) {
+            continue;
+        }
+        const unsigned shift = SLOT_BITS * level;
+        const uint64_t base = (current_tick_ >> shift) + 1;
+        const uint64_t rotated = rotate_right(occupied_[level], static_cast<unsigned>(base & (SLOTS - 1)));
+        const uint64_t tick = (base + static_cast<uint64_t>(__builtin_ctzll(rotated))) << shift;
+        if (tick < next_tick) {
+            next_tick = tick;
+        }
+    }
+
+    const uint64_t deadline_ms = start_ms_ + next_tick * TICK_MS;
+    if (deadline_ms <= now_ms) {
+        return 0;
+    }
+    const uint64_t delay = deadline_ms - now_ms;
+    if (max_timeout_ms >= 0 && delay > static_cast<uint64_t>(max_timeout_ms)) {
+        return max_timeout_ms;
+    }
+    return delay > INT32_MAX ? INT32_MAX : static_cast<int>(delay);
+}
+
+size_t TimerWheel::size() const {
+    return count_;
+}
+
+bool TimerWheel::empty() const {
+    return count_ == 0;
+}
+
+uint32_t TimerWheel::allocate_node() {
+    if (!free_nodes_.empty()) {
+        const uint32_t index = free_nodes_.back();
+        free_nodes_.pop_back();
+        return index;
+    }
+    nodes_.push_back(Node());
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerWheel::link(uint32_t index) {
+    Node& node = nodes_[index];
+    const uint64_t delta = node.deadline_tick > current_tick_ ? node.deadline_tick - current_tick_ : 0;
+
+    unsigned level = 0;
+    while (level < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    unsigned slot;
+    if (level == LEVELS) {
+        // Au-delà de la portée de la roue : réinséré lors de la dernière descente possible
+        level = LEVELS - 1;
+        slot = static_cast<unsigned>((current_tick_ >> (SLOT_BITS * level)) & (SLOTS - 1));
+    } else {
+        slot = static_cast<unsigned>((node.deadline_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    }
+
+    const unsigned position = level * SLOTS + slot;
+    node.slot = static_cast<uint16_t>(position);
+    node.prev = NIL;
+    node.next = heads_[position];
+    if (node.next != NIL) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[position] = index;
+    occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+    if (heads_[node.slot] == NIL) {
+        occupied_[node.slot / SLOTS] &= ~(uint64_t(1) << (node.slot % SLOTS));
+    }
+}
+
+// Les timers de la case courante du niveau sont redistribués dans les niveaux inférieurs
+void TimerWheel::cascade(unsigned level) {
+    const unsigned slot = static_cast<unsigned>((current_tick_ >> (SLOT_BITS * level)) & (SLOTS - 1));
+    const unsigned position = level * SLOTS + slot;
+    uint32_t index = heads_[position];
+    heads_[position] = NIL;
+    occupied_[level] &= ~(uint64_t(1) << slot);
+    while (index != NIL) {
+        const uint32_t next = nodes_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+uint64_t TimerWheel::to_tick(uint64_t time_ms) const {
+    if (time_ms <= start_ms_) {
+        return 0;
+    }
+    // Arrondi supérieur : un timer n'expire jamais avant son échéance
+    return (time_ms - start_ms_ + TICK_MS - 1) / TICK_MS;
+}
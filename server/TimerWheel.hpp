@@ -0,0 +1,80 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Roue de temporisation hiérarchique : 4 niveaux de 64 cases, pas de TICK_MS.
+// Armer et annuler un timer coûtent O(1) (listes chaînées intrusives dans un
+// pool de nœuds) ; un timer lointain descend d'un niveau à chaque tour de la
+// roue inférieure. Un bitmap par niveau donne la prochaine échéance sans
+// parcourir les cases.
+class TimerWheel {
+public:
+    using TimerId = uint32_t;
+    static constexpr TimerId INVALID_TIMER = 0xFFFFFFFFu;
+    static constexpr uint64_t TICK_MS = 10;
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+
+    struct Expired {
+        TimerId id;
+        uint64_t user_data;
+    };
+
+private:
+    struct Node {
+        uint64_t deadline_tick;
+        uint64_t user_data;
+        uint32_t prev;
+        uint32_t next;
+        uint16_t slot;   // niveau * SLOTS + case
+        bool active;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::vector<uint32_t> retired_;  // Expirés au dernier advance(), recyclés au suivant
+    uint32_t heads_[LEVELS * SLOTS];
+    uint64_t occupied_[LEVELS];      // Bitmap des cases non vides par niveau
+    uint64_t start_ms_;
+    uint64_t current_tick_;
+    size_t count_;
+
+public:
+    // Forme canonique de Coplien (une copie est une roue vide à la même origine)
+    TimerWheel();
+    TimerWheel(const TimerWheel& other);
+    TimerWheel& operator=(const TimerWheel& other);
+    ~TimerWheel() = default;
+
+    TimerWheel(TimerWheel&& other) noexcept;
+    TimerWheel& operator=(TimerWheel&& other) noexcept;
+
+    // Vide la roue et fixe son origine
+    void reset(uint64_t now_ms);
+
+    // Le timer expire au premier advance() dont l'heure atteint deadline_ms
+    TimerId schedule(uint64_t deadline_ms, uint64_t user_data);
+    void cancel(TimerId id);
+
+    // Fait tourner la roue jusqu'à now_ms ; les timers échus sont ajoutés à expired
+    size_t advance(uint64_t now_ms, std::vector<Expired>& expired);
+
+    // Délai avant la prochaine échéance (ou avant la descente d'un niveau), borné par max_timeout_ms
+    int next_timeout(uint64_t now_ms, int max_timeout_ms) const;
+
+    size_t size() const;
+    bool empty() const;
+
+private:
+    uint32_t allocate_node();
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(unsigned level);
+    uint64_t to_tick(uint64_t time_ms) const;
+};
+
+#endif // TIMER_WHEEL_HPP
@@ -0,0 +1,249 @@
+#include "WriteQueue.hpp"
+#include <sys/uio.h>
+#include <errno.h>
+#include <cstring>
+#include <arpa/inet.h>
+
+// Nombre maximum de segments envoyés par appel à sendmsg
+static const int FLUSH_BATCH = 64;
+static const size_t FRAME_HEADER_SIZE = 12;
+
+// Fin de la trame LPTF qui commence à offset (bornée à la fin du tampon)
+static size_t frame_end(const std::vector<uint8_t>& data, size_t offset) {
+    if (data.size() - offset < FRAME_HEADER_SIZE) {
+        return data.size();
+    }
+    uint32_t payload_length;
+    std::memcpy(&payload_length, data.data() + offset + 8, 4);
+    payload_length = ntohl(payload_length);
+    const size_t left = data.size() - offset - FRAME_HEADER_SIZE;
+    return offset + FRAME_HEADER_SIZE + (payload_length < left ? payload_length : left);
+}
+
+WriteQueue::WriteQueue()
+    : head_(0), count_(0), max_segments_(DEFAULT_MAX_SEGMENTS), queued_bytes_(0),
+      high_watermark_(DEFAULT_HIGH_WATERMARK), low_watermark_(DEFAULT_LOW_WATERMARK),
+      bulk_bytes_(0), bulk_fragment_end_(0) {
+}
+
+WriteQueue::WriteQueue(size_t high_watermark, size_t low_watermark, size_t max_segments)
+    : head_(0), count_(0), max_segments_(max_segments), queued_bytes_(0),
+      high_watermark_(high_watermark), low_watermark_(low_watermark),
+      bulk_bytes_(0), bulk_fragment_end_(0) {
+    if (low_watermark_ > high_watermark_) {
+        low_watermark_ = high_watermark_;
+    }
+}
+
+bool WriteQueue::push(const SharedBuffer& data) {
+    if (!data || data->empty()) {
+        return true;
+    }
+
+    if (count_ == ring_.size()) {
+        if (ring_.size() >= max_segments_) {
+            return false;
+        }
+        // L'anneau grandit par doublement et est remis à plat (tête en 0)
+        size_t new_size = ring_.empty() ? 16 : ring_.size() * 2;
+        if (new_size > max_segments_) {
+            new_size = max_segments_;
+        }
+        std::vector<Segment> grown(new_size);
+        for (size_t i = 0; i < count_; ++i) {
+            grown[i] = std::move(ring_[(head_ + i) % ring_.size()]);
+        }
+        ring_ = std::move(grown);
+        head_ = 0;
+    }
+
+    ring_[(head_ + count_) % ring_.size()] = Segment{data, 0};
+    ++count_;
+    queued_bytes_ += data->size();
+    return true;
+}
+
+bool WriteQueue::push_bulk(const SharedBuffer& data) {
+    if (!data || data->empty()) {
+        return true;
+    }
+    if (!bulk_.empty() && data->size() > MAX_BULK_BYTES - bulk_bytes_) {
+        return false;
+    }
+    bulk_.push_back(Segment{data, 0});
+    bulk_bytes_ += data->size();
+    return true;
+}
+
+// Le flux ne change de voie qu'entre deux trames : un fragment entamé est
+// terminé seul, puis la voie normale passe avant le fragment suivant. Sans
+// message normal en attente, la voie des fragments part d'un bloc
+ssize_t WriteQueue::flush(const LPTF_Socket& socket) {
+    ssize_t total_sent = 0;
+
+    while (count_ > 0 || !bulk_.empty()) {
+        struct iovec iov[FLUSH_BATCH];
+        int iov_count = 0;
+        size_t normal_length = 0;
+        size_t requested = 0;
+
+        if (bulk_fragment_end_ == 0) {
+            for (size_t i = 0; i < count_ && iov_count < FLUSH_BATCH - 1; ++i) {
+                const Segment& segment = ring_[(head_ + i) % ring_.size()];
+                iov[iov_count].iov_base = const_cast<uint8_t*>(segment.data->data() + segment.offset);
+                iov[iov_count].iov_len = segment.data->size() - segment.offset;
+                normal_length += iov[iov_count].iov_len;
+                ++iov_count;
+            }
+        }
+        if (!bulk_.empty()) {
+            const Segment& front = bulk_.front();
+            size_t end = front.data->size();
+            if (count_ > 0) {
+                end = bulk_fragment_end_ != 0 ? bulk_fragment_end_ : frame_end(*front.data, front.offset);
+            }
+            iov[iov_count].iov_base = const_cast<uint8_t*>(front.data->data() + front.offset);
+            iov[iov_count].iov_len = end - front.offset;
+            ++iov_count;
+            for (size_t i = 1; count_ == 0 && i < bulk_.size() && iov_count < FLUSH_BATCH; ++i) {
+                iov[iov_count].iov_base = const_cast<uint8_t*>(bulk_[i].data->data());
+                iov[iov_count].iov_len = bulk_[i].data->size();
+                ++iov_count;
+            }
+        }
+        for (int i = 0; i < iov_count; ++i) {
+            requested += iov[i].iov_len;
+        }
+
+        ssize_t sent = socket.send_vectored(iov, iov_count);
+        if (sent == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+
+        total_sent += sent;
+        const size_t normal_sent = static_cast<size_t>(sent) < normal_length ? static_cast<size_t>(sent) : normal_length;
+        queued_bytes_ -= normal_sent;
+
+        // Avance dans les segments (envoi partiel possible)
+        size_t remaining = normal_sent;
+        while (remaining > 0 && count_ > 0) {
+            Segment& segment = ring_[head_];
+            const size_t left = segment.data->size() - segment.offset;
+            if (remaining >= left) {
+                remaining -= left;
+                pop_front();
+            } else {
+                segment.offset += remaining;
+                remaining = 0;
+            }
+        }
+
+        // Puis dans les fragments, en retenant la fin de celui resté entamé
+        remaining = static_cast<size_t>(sent) - normal_sent;
+        bulk_bytes_ -= remaining;
+        while (remaining > 0 && !bulk_.empty()) {
+            Segment& segment = bulk_.front();
+            const size_t end = bulk_fragment_end_ != 0 ? bulk_fragment_end_ : frame_end(*segment.data, segment.offset);
+            const size_t step = remaining < end - segment.offset ? remaining : end - segment.offset;
+            segment.offset += step;
+            remaining -= step;
+            bulk_fragment_end_ = segment.offset < end ? end : 0;
+            if (segment.offset == segment.data->size()) {
+                bulk_.pop_front();
+            }
+        }
+
+        // Le noyau n'a pas tout accepté : le reste attendra POLLOUT
+        if (static_cast<size_t>(sent) < requested) {
+            break;
+        }
+    }
+
+    return total_sent;
+}
+
+size_t WriteQueue::drop_oldest(size_t target_bytes, size_t target_segments) {
+    size_t dropped = 0;
+
+    // Le segment de tête déjà entamé doit être terminé pour ne pas corrompre le flux
+    size_t keep = (count_ > 0 && ring_[head_].offset > 0) ? 1 : 0;
+
+    while ((queued_bytes_ > target_bytes || count_ > target_segments) && count_ > keep) {
+        const size_t index = (head_ + keep) % ring_.size();
+        const size_t size = ring_[index].data->size();
+
+        // Décale les segments conservés d'un cran pour combler le trou
+        for (size_t i = keep; i > 0; --i) {
+            ring_[(head_ + i) % ring_.size()] = std::move(ring_[(head_ + i - 1) % ring_.size()]);
+        }
+        ring_[head_].data.reset();
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+
+        queued_bytes_ -= size;
+        ++dropped;
+    }
+
+    return dropped;
+}
+
+bool WriteQueue::empty() const {
+    return count_ == 0 && bulk_.empty();
+}
+
+size_t WriteQueue::get_queued_bytes() const {
+    return queued_bytes_;
+}
+
+size_t WriteQueue::get_bulk_bytes() const {
+    return bulk_bytes_;
+}
+
+size_t WriteQueue::get_segment_count() const {
+    return count_;
+}
+
+size_t WriteQueue::get_max_segments() const {
+    return max_segments_;
+}
+
+bool WriteQueue::is_above_high_watermark() const {
+    return queued_bytes_ > high_watermark_;
+}
+
+bool WriteQueue::is_below_low_watermark() const {
+    return queued_bytes_ <= low_watermark_;
+}
+
+size_t WriteQueue::get_high_watermark() const {
+    return high_watermark_;
+}
+
+size_t WriteQueue::get_low_watermark() const {
+    return low_watermark_;
+}
+
+void WriteQueue::set_watermarks(size_t high_watermark, size_t low_watermark) {
+    high_watermark_ = high_watermark;
+    low_watermark_ = low_watermark > high_watermark ? high_watermark : low_watermark;
+}
+
+void WriteQueue::clear() {
+    ring_.clear();
+    head_ = 0;
+    count_ = 0;
+    queued_bytes_ = 0;
+    bulk_.clear();
+    bulk_bytes_ = 0;
+    bulk_fragment_end_ = 0;
+}
+
+void WriteQueue::pop_front() {
+    ring_[head_].data.reset();
+    ring_[head_].offset = 0;
+    head_ = (head_ + 1) % ring_.size();
+    --count_;
+}
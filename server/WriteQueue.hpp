@@ -0,0 +1,100 @@
+#ifndef WRITE_QUEUE_HPP
+#define WRITE_QUEUE_HPP
+
+#include "LPTF_socket.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+// Tampon immuable partagé entre plusieurs files d'envoi
+using SharedBuffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+inline SharedBuffer make_shared_buffer(std::vector<uint8_t>&& data) {
+    return std::make_shared<const std::vector<uint8_t>>(std::move(data));
+}
+
+inline SharedBuffer make_shared_buffer(const std::string& data) {
+    return std::make_shared<const std::vector<uint8_t>>(data.begin(), data.end());
+}
+
+// Comportement lorsqu'un client dépasse son budget (high watermark)
+enum class OverflowPolicy {
+    DROP_OLDEST,  // Les messages les plus anciens non commencés sont abandonnés
+    DISCONNECT,   // Le client lent est déconnecté
+    BLOCK         // L'émetteur attend (borné) que le client se vide
+};
+
+// File d'envoi d'une connexion : anneau de segments (référence + position)
+// vidé sur POLLOUT. Un segment partiellement envoyé n'est jamais abandonné,
+// le flux reste donc cohérent même quand des messages sont supprimés.
+// Une seconde voie reçoit les trames fragmentées des gros messages : elle
+// n'avance que d'un fragment entre deux passages de la voie normale, si bien
+// qu'un transfert volumineux ne retarde jamais le chat de plus d'un fragment.
+class WriteQueue {
+private:
+    struct Segment {
+        SharedBuffer data;
+        size_t offset;
+    };
+
+    std::vector<Segment> ring_;
+    size_t head_;
+    size_t count_;
+    size_t max_segments_;
+    size_t queued_bytes_;
+    size_t high_watermark_;
+    size_t low_watermark_;
+    
+    // Voie des fragments, hors watermarks : jamais abandonnée partiellement
+    std::deque<Segment> bulk_;
+    size_t bulk_bytes_;
+    size_t bulk_fragment_end_; // Fin du fragment entamé en tête de voie (0 : aucun)
+
+public:
+    static constexpr size_t DEFAULT_MAX_SEGMENTS = 4096;
+    static constexpr size_t DEFAULT_HIGH_WATERMARK = 1024 * 1024;
+    static constexpr size_t DEFAULT_LOW_WATERMARK = 256 * 1024;
+    // Budget de la voie des fragments
+    static constexpr size_t MAX_BULK_BYTES = 64 * 1024 * 1024;
+
+    // Forme canonique de Coplien
+    WriteQueue();
+    WriteQueue(size_t high_watermark, size_t low_watermark, size_t max_segments = DEFAULT_MAX_SEGMENTS);
+    WriteQueue(const WriteQueue& other) = default;
+    WriteQueue& operator=(const WriteQueue& other) = default;
+    ~WriteQueue() = default;
+
+    WriteQueue(WriteQueue&& other) noexcept = default;
+    WriteQueue& operator=(WriteQueue&& other) noexcept = default;
+
+    // Retourne false si l'anneau de segments est plein
+    bool push(const SharedBuffer& data);
+    // Suite de trames complètes (fragments) ; false si le budget est dépassé
+    bool push_bulk(const SharedBuffer& data);
+
+    // Envoie autant que possible sans bloquer. Retourne les octets envoyés, -1 si erreur fatale
+    ssize_t flush(const LPTF_Socket& socket);
+
+    // Abandonne les segments les plus anciens non commencés jusqu'à revenir
+    // sous target_bytes et target_segments
+    size_t drop_oldest(size_t target_bytes, size_t target_segments);
+
+    bool empty() const;
+    size_t get_queued_bytes() const;
+    size_t get_bulk_bytes() const;
+    size_t get_segment_count() const;
+    size_t get_max_segments() const;
+    bool is_above_high_watermark() const;
+    bool is_below_low_watermark() const;
+    size_t get_high_watermark() const;
+    size_t get_low_watermark() const;
+    void set_watermarks(size_t high_watermark, size_t low_watermark);
+    void clear();
+
+private:
+    void pop_front();
+};
+
+#endif // WRITE_QUEUE_HPP
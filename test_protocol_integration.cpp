@@ -1,6 +1,83 @@
 #include "protocole/LPTF_Protocol.hpp"
+#include "protocole/LPTF_Framing.hpp"
+#include "protocole/LPTF_PacketView.hpp"
+#include "protocole/LPTF_Schema.hpp"
+#include "protocole/LPTF_Dispatch.hpp"
+#include "protocole/LPTF_Compression.hpp"
+#include "protocole/LPTF_Fragment.hpp"
+#include "server/MessageLog.hpp"
+#include "server/WriteQueue.hpp"
+#include "server/TimerWheel.hpp"
+#include "server/RoomHistory.hpp"
+#include "server/Server.hpp"
+#include "server/Logger.hpp"
+#include "client/Client.hpp"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <thread>
+#include <chrono>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Segments du journal, du plus ancien au plus récent
+std::vector<std::string> list_segments(const std::string& directory) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(directory.c_str());
+    while (dir) {
+        dirent* entry = readdir(dir);
+        if (!entry) {
+            closedir(dir);
+            break;
+        }
+        if (entry->d_name[0] != '.') {
+            names.push_back(directory + "/" + entry->d_name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Lit tout ce qui est disponible sur fd (non bloquant) ; false si le flux LPTF est corrompu
+bool read_available(int fd, LPTF::FrameReassembler& input) {
+    while (true) {
+        uint8_t* buffer = input.prepare(4096);
+        const ssize_t received = recv(fd, buffer, input.writable_size(), MSG_DONTWAIT);
+        if (received <= 0) {
+            return !input.is_corrupted();
+        }
+        input.commit(static_cast<size_t>(received));
+    }
+}
+
+// Numéros (timestamp) des CHAT_MESSAGE complets reçus ; false sur une trame invalide
+bool collect_chats(LPTF::FrameReassembler& input, std::vector<uint64_t>& numbers) {
+    const uint8_t* frame = nullptr;
+    size_t frame_size = 0;
+    while (input.next_frame(frame, frame_size)) {
+        LPTF::LPTF_PacketView view(frame, frame_size);
+        uint64_t number = 0;
+        if (!view.is_valid() || !view.get_uint64("timestamp", number)) {
+            return false;
+        }
+        numbers.push_back(number);
+    }
+    return !input.is_corrupted();
+}
+
+bool is_increasing(const std::vector<uint64_t>& numbers) {
+    for (size_t i = 1; i < numbers.size(); ++i) {
+        if (numbers[i] <= numbers[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
 
 void print_hex(const std::vector<uint8_t>& data) {
     for (size_t i = 0; i < data.size(); ++i) {
@@ -56,6 +133,620 @@ int main() {
     std::cout << "   " << ping_packet.to_string() << std::endl;
     std::cout << "   Has REQUIRES_ACK flag: " << (ping_packet.has_flag(LPTF::PacketFlags::REQUIRES_ACK) ? "Yes" : "No") << std::endl;
     
+    // Test 4: Framing (trames coalescées puis découpées octet par octet)
+    std::cout << "\n4. Testing Frame Reassembly:" << std::endl;
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 3; ++i) {
+        std::vector<uint8_t> frame = LPTF::ChatMessage::create("bob", "msg " + std::to_string(i), i).serialize();
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    
+    LPTF::FrameReassembler coalesced;
+    coalesced.append(stream.data(), stream.size());
+    int coalesced_frames = 0;
+    std::vector<uint8_t> frame;
+    while (coalesced.next_frame(frame)) {
+        coalesced_frames++;
+    }
+    
+    LPTF::FrameReassembler split;
+    int split_frames = 0;
+    for (uint8_t byte : stream) {
+        split.append(&byte, 1);
+        while (split.next_frame(frame)) {
+            LPTF::LPTF_Packet packet;
+            if (packet.deserialize(frame)) split_frames++;
+        }
+    }
+    std::cout << "   Coalesced: " << coalesced_frames << " frames, split: " << split_frames << " frames" << std::endl;
+    if (coalesced_frames != 3 || split_frames != 3) {
+        std::cout << "   ✗ Frame reassembly failed" << std::endl;
+        return 1;
+    }
+    
+    // Test 5: Packet view (lecture sans allocation)
+    std::cout << "\n5. Testing Packet View:" << std::endl;
+    LPTF::LPTF_PacketView view(serialized.data(), serialized.size());
+    std::string_view view_username;
+    uint64_t view_timestamp = 0;
+    if (!view.is_valid() || !view.get_string("username", view_username) ||
+        !view.get_uint64("timestamp", view_timestamp) || view_username != "bob") {
+        std::cout << "   ✗ Packet view failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ View: " << view.get_field_count() << " fields, username=" << view_username 
+              << ", timestamp=" << view_timestamp << std::endl;
+    
+    // Test 6: Schéma compilé et serialize_into (trames identiques à LPTF_Packet::serialize)
+    std::cout << "\n6. Testing Chat Message Schema:" << std::endl;
+    std::vector<uint8_t> encoded = LPTF::ChatMessage::encode("bob", "Hello LPTF!", 1690123456789ULL);
+    std::string schema_username, schema_message;
+    uint64_t schema_timestamp = 0;
+    uint8_t frame_buffer[256];
+    const size_t written = chat_packet.serialize_into(frame_buffer, sizeof(frame_buffer));
+    if (encoded != serialized || written != chat_packet.serialized_size() ||
+        !std::equal(serialized.begin(), serialized.end(), frame_buffer) ||
+        !LPTF::ChatMessage::parse(encoded.data(), encoded.size(), schema_username, schema_message, schema_timestamp) ||
+        schema_username != "bob" || schema_message != "Hello LPTF!" || schema_timestamp != 1690123456789ULL) {
+        std::cout << "   ✗ Schema encoding failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ Schema frame matches packet serialization (" << encoded.size() << " bytes)" << std::endl;
+    
+    // Test 7: Scatter-gather (gros BINARY référencé en place)
+    std::cout << "\n7. Testing Scatter-Gather Serialization:" << std::endl;
+    LPTF::LPTF_Packet blob_packet(LPTF::MessageType::FILE_TRANSFER);
+    blob_packet.set_string("filename", "blob.bin");
+    blob_packet.set_binary("data", std::vector<uint8_t>(60000, 0xAB));
+    std::vector<uint8_t> scratch, gathered;
+    std::vector<struct iovec> iov;
+    const size_t frame_size = blob_packet.serialize_gather(scratch, iov);
+    for (const struct iovec& part : iov) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(part.iov_base);
+        gathered.insert(gathered.end(), bytes, bytes + part.iov_len);
+    }
+    if (gathered != blob_packet.serialize() || frame_size != gathered.size() || scratch.size() > 64) {
+        std::cout << "   ✗ Scatter-gather serialization failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << frame_size << " bytes in " << iov.size() << " iovecs, "
+              << scratch.size() << " bytes copied" << std::endl;
+    
+    // Test 8: Table de dispatch (types système compris) et réponse ERROR
+    std::cout << "\n8. Testing Dispatch Table:" << std::endl;
+    LPTF::DispatchTable<int (*)(int)> table;
+    table.set(LPTF::MessageType::CHAT_MESSAGE, [](int value) { return value + 1; });
+    table.set(LPTF::MessageType::PING, [](int value) { return value * 2; });
+    const std::vector<uint8_t> error_frame = LPTF::ErrorSchema::serialize(LPTF::ErrorSchema::Values(
+        static_cast<uint32_t>(LPTF::ErrorCode::UNKNOWN_MESSAGE_TYPE), "Type de message inconnu", 0x1234u));
+    LPTF::LPTF_PacketView error_view(error_frame.data(), error_frame.size());
+    uint32_t rejected_type = 0;
+    if (table.find(LPTF::MessageType::CHAT_MESSAGE)(1) != 2 || table.find(LPTF::MessageType::PING)(3) != 6 ||
+        table.contains(LPTF::MessageType::PONG) || table.contains(static_cast<LPTF::MessageType>(0x1234)) ||
+        !error_view.is_valid() || error_view.get_message_type() != LPTF::MessageType::ERROR ||
+        !error_view.get_uint32("rejected_type", rejected_type) || rejected_type != 0x1234) {
+        std::cout << "   ✗ Dispatch table failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ Handlers found by type, unknown types rejected" << std::endl;
+
+    // Test 9: Reprise d'un salon (last_seq dans ROOM_JOIN, séquence dans l'ACK)
+    std::cout << "\n9. Testing Room Resume Schemas:" << std::endl;
+    const std::vector<uint8_t> resume_frame = LPTF::RoomResumeSchema::serialize(
+        LPTF::RoomResumeSchema::Values(uint64_t(41), "dev"));
+    const std::vector<uint8_t> room_ack_frame = LPTF::RoomAckSchema::serialize(
+        LPTF::RoomAckSchema::Values("dev", uint64_t(42)));
+    LPTF::LPTF_PacketView resume_view(resume_frame.data(), resume_frame.size());
+    LPTF::RoomAckSchema::Values room_ack;
+    uint64_t last_seq = 0;
+    if (!resume_view.is_valid() || resume_view.get_message_type() != LPTF::MessageType::ROOM_JOIN ||
+        !resume_view.get_uint64("last_seq", last_seq) || last_seq != 41 ||
+        !LPTF::RoomAckSchema::decode(room_ack_frame.data(), room_ack_frame.size(), room_ack) ||
+        LPTF::RoomAckSchema::get<LPTF::fields::Seq>(room_ack) != 42) {
+        std::cout << "   ✗ Room resume schemas failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ last_seq and ACK sequence round-trip" << std::endl;
+
+    // Test 10: Compression transparente (seuil, flag COMPRESSED, trame refusée par la vue)
+    std::cout << "\n10. Testing Frame Compression:" << std::endl;
+    std::string process_list;
+    for (int pid = 1; pid <= 200; ++pid) {
+        process_list += "PID " + std::to_string(pid) + ": /usr/bin/worker --config /etc/worker.conf\n";
+    }
+    LPTF::LPTF_Packet list_packet(LPTF::MessageType::PROCESS_LIST_RESPONSE);
+    list_packet.set_string("process_list", process_list);
+    LPTF::LPTF_Packet small_packet(LPTF::MessageType::PING);
+    small_packet.set_compression_threshold(LPTF::Compression::DEFAULT_THRESHOLD);
+    const std::vector<uint8_t> raw_list = list_packet.serialize();
+    list_packet.set_compression_threshold(LPTF::Compression::DEFAULT_THRESHOLD);
+    const std::vector<uint8_t> compressed_frame = list_packet.serialize();
+    LPTF::LPTF_PacketView compressed_view(compressed_frame.data(), compressed_frame.size());
+    LPTF::LPTF_Packet inflated;
+    std::vector<uint8_t> plain_frame;
+    // Taille d'origine hors de portée du bloc : refusée avant toute allocation
+    std::vector<uint8_t> forged_frame = compressed_frame;
+    forged_frame[12] = 0x00;
+    forged_frame[13] = 0xFF;
+    forged_frame[14] = 0x00;
+    forged_frame[15] = 0x00;
+    std::vector<uint8_t> forged_out;
+    const bool forged_accepted =
+        LPTF::Compression::decompress_frame(forged_frame.data(), forged_frame.size(), forged_out);
+    if (!LPTF::Compression::is_compressed(compressed_frame.data(), compressed_frame.size()) ||
+        compressed_frame.size() * 4 > raw_list.size() || compressed_view.is_valid() ||
+        !inflated.deserialize(compressed_frame) || inflated.has_flag(LPTF::PacketFlags::COMPRESSED) ||
+        inflated.get_string("process_list") != process_list ||
+        !LPTF::Compression::decompress_frame(compressed_frame.data(), compressed_frame.size(), plain_frame) ||
+        plain_frame != raw_list || forged_accepted || forged_out.capacity() != 0 || small_packet.serialize() != LPTF::LPTF_Packet(LPTF::MessageType::PING).serialize()) {
+        std::cout << "   ✗ Frame compression failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << raw_list.size() << " bytes sent as " << compressed_frame.size() << std::endl;
+
+    // Test 11: Champs de plus de 64 Ko et fragmentation (flux intercalés, limites)
+    std::cout << "\n11. Testing Large Fields and Fragmentation:" << std::endl;
+    const std::vector<uint8_t> blob(200000, 0x5A);
+    LPTF::LPTF_Packet file_packet(LPTF::MessageType::FILE_TRANSFER);
+    file_packet.set_binary("data", blob);
+    const std::vector<uint8_t> blob_frame = file_packet.serialize();
+    LPTF::LPTF_Packet blob_copy;
+    LPTF::ByteSpan blob_span;
+    const std::string long_message(70000, 'm');
+    const std::vector<uint8_t> long_error_frame = LPTF::ErrorSchema::serialize(LPTF::ErrorSchema::Values(2, long_message, 0));
+    std::string_view long_view;
+    
+    std::vector<uint8_t> fragments;
+    uint32_t stream_id = 7;
+    std::vector<uint8_t> pair = blob_frame;
+    pair.insert(pair.end(), long_error_frame.begin(), long_error_frame.end());
+    const bool fragmented = LPTF::Fragmentation::split_frames(pair.data(), pair.size(), stream_id, fragments);
+    
+    // Les fragments des deux flux sont réassemblés dans un ordre alterné
+    std::vector<LPTF::ByteSpan> streams[2];
+    LPTF::FrameReassembler fragment_input;
+    fragment_input.append(fragments.data(), fragments.size());
+    const uint8_t* fragment = nullptr;
+    size_t fragment_size = 0;
+    while (fragment_input.next_frame(fragment, fragment_size)) {
+        streams[fragment[15] == 7 ? 0 : 1].push_back(LPTF::ByteSpan(fragment, fragment_size));
+    }
+    LPTF::FragmentReassembler reassembler;
+    std::vector<std::vector<uint8_t>> rebuilt;
+    for (size_t i = 0; i < streams[0].size() || i < streams[1].size(); ++i) {
+        for (const std::vector<LPTF::ByteSpan>& stream : streams) {
+            LPTF::ByteSpan message;
+            if (i < stream.size() &&
+                reassembler.add(stream[i].data, stream[i].size, message) == LPTF::FragmentStatus::COMPLETE) {
+                rebuilt.emplace_back(message.data, message.data + message.size);
+            }
+        }
+    }
+    
+    LPTF::FragmentReassembler small_reassembler(1, 1024);
+    LPTF::ByteSpan ignored;
+    const LPTF::FragmentStatus too_large = small_reassembler.add(streams[0][0].data, streams[0][0].size, ignored);
+    const LPTF::FragmentStatus out_of_order = reassembler.add(streams[0][1].data, streams[0][1].size, ignored);
+    if (!blob_copy.deserialize(blob_frame) || blob_copy.get_binary("data") != blob ||
+        !LPTF::LPTF_PacketView(blob_frame.data(), blob_frame.size()).get_binary("data", blob_span) ||
+        blob_span.size != blob.size() ||
+        !LPTF::LPTF_PacketView(long_error_frame.data(), long_error_frame.size()).get_string("message", long_view) ||
+        long_view != long_message || !fragmented || stream_id != 9 || rebuilt.size() != 2 ||
+        rebuilt[1] != blob_frame || rebuilt[0] != long_error_frame || reassembler.get_buffered_bytes() != 0 ||
+        too_large != LPTF::FragmentStatus::LIMIT || out_of_order != LPTF::FragmentStatus::INVALID) {
+        std::cout << "   ✗ Fragmentation failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << streams[0].size() + streams[1].size() << " fragments reassembled into 2 messages" << std::endl;
+
+    // Test 12: Journal persistant (rotation, rétention, reprise par l'index, fin tronquée)
+    std::cout << "\n12. Testing Message Log:" << std::endl;
+    char log_template[] = "/tmp/lptf_log_XXXXXX";
+    const std::string log_dir = mkdtemp(log_template) ? log_template : "";
+    const uint64_t log_count = 2000;
+    {
+        MessageLog writer(64 * 1024, 2, 0);
+        if (log_dir.empty() || !writer.open(log_dir) || !writer.start()) {
+            std::cout << "   ✗ Message log open failed" << std::endl;
+            return 1;
+        }
+        // Plusieurs trames par tampon, comme un lot relayé
+        for (uint64_t i = 1; i <= log_count; i += 10) {
+            std::vector<uint8_t> batch;
+            for (uint64_t j = i; j < i + 10; ++j) {
+                const std::vector<uint8_t> frame =
+                    LPTF::ChatMessage::create("bob", "message " + std::to_string(j), j).serialize();
+                batch.insert(batch.end(), frame.begin(), frame.end());
+            }
+            while (!writer.append("lobby", make_shared_buffer(std::move(batch)))) {
+                usleep(1000);
+            }
+        }
+        writer.close();
+    }
+    
+    // Reprise après un arrêt brutal : le dernier enregistrement est coupé en deux
+    std::vector<std::string> segment_files = list_segments(log_dir);
+    const std::string last_segment = segment_files.empty() ? "" : segment_files.back();
+    struct stat last_stat;
+    const bool truncated = !segment_files.empty() && stat(last_segment.c_str(), &last_stat) == 0 &&
+                           last_stat.st_size > 8 && truncate(last_segment.c_str(), last_stat.st_size - 8) == 0;
+    
+    MessageLog reader(64 * 1024, 2, 0);
+    const bool reopened = reader.open(log_dir);
+    const uint64_t next_after_truncation = reader.get_next_seq();
+    std::vector<uint64_t> replayed;
+    bool entries_ok = true;
+    reader.for_each_from(0, [&](const LogEntry& entry) {
+        LPTF::LPTF_PacketView view(entry.frame.data, entry.frame.size);
+        std::string_view text;
+        entries_ok = entries_ok && entry.room == "lobby" && view.get_string("message", text) &&
+                     text == "message " + std::to_string(entry.log_seq);
+        replayed.push_back(entry.log_seq);
+        return true;
+    });
+    // Reprise au milieu d'un segment : l'index clairsemé évite de relire depuis son début
+    const uint64_t resume_seq = log_count - 100;
+    std::vector<uint64_t> resumed;
+    reader.for_each_from(resume_seq, [&](const LogEntry& entry) {
+        resumed.push_back(entry.log_seq);
+        return resumed.size() < 10;
+    });
+    
+    // L'enregistrement suivant reprend le numéro de celui qui a été perdu
+    const bool restarted = reader.start() &&
+        reader.append("lobby", make_shared_buffer(
+            LPTF::ChatMessage::create("bob", "message " + std::to_string(log_count), log_count).serialize()));
+    reader.close();
+    MessageLog final_reader(64 * 1024, 2, 0);
+    uint64_t final_seq = 0;
+    const bool final_opened = final_reader.open(log_dir);
+    final_reader.for_each_from(log_count, [&](const LogEntry& entry) {
+        final_seq = entry.log_seq;
+        return true;
+    });
+    const uint64_t final_next = final_reader.get_next_seq();
+    final_reader.close();
+    
+    bool contiguous = !replayed.empty() && replayed.back() == log_count - 1;
+    for (size_t i = 1; i < replayed.size(); ++i) {
+        contiguous = contiguous && replayed[i] == replayed[i - 1] + 1;
+    }
+    bool resumed_ok = resumed.size() == 10;
+    for (size_t i = 0; i < resumed.size(); ++i) {
+        resumed_ok = resumed_ok && resumed[i] == resume_seq + i;
+    }
+    for (const std::string& file : list_segments(log_dir)) {
+        unlink(file.c_str());
+    }
+    rmdir(log_dir.c_str());
+    if (segment_files.size() != 2 || !truncated || !reopened || next_after_truncation != log_count ||
+        !entries_ok || !contiguous || replayed.front() == 1 || replayed.size() > log_count - 1 ||
+        !resumed_ok || !restarted || !final_opened || final_seq != log_count || final_next != log_count + 1) {
+        std::cout << "   ✗ Message log failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << replayed.size() << " records replayed from " << segment_files.size()
+              << " segments, resumed at " << resume_seq << std::endl;
+
+    // Test 13: Session LPTF contre un serveur réel (HELLO, compression négociée, relais)
+    std::cout << "\n13. Testing Compression Negotiation with a Live Server:" << std::endl;
+    const int session_port = 19299;
+    const pid_t server_pid = fork();
+    if (server_pid == 0) {
+        Logger::instance().set_level(LogLevel::ERROR);
+        Server server("127.0.0.1", session_port, 10);
+        server.run();
+        _exit(0);
+    }
+    // Un relais qui n'arrive jamais termine le test au lieu de le bloquer
+    alarm(10);
+    Client sender("127.0.0.1", session_port);
+    Client receiver("127.0.0.1", session_port);
+    bool connected = false;
+    for (int attempt = 0; attempt < 50 && !connected; ++attempt) {
+        usleep(20000);
+        connected = sender.connect_to_server();
+    }
+    const bool sessions = connected && sender.open_session() && receiver.connect_to_server() &&
+                          receiver.open_session();
+    
+    // Assez répétitif pour partir compressé dans les deux sens
+    std::string long_chat;
+    for (int line = 0; line < 100; ++line) {
+        long_chat += "ligne " + std::to_string(line) + " : le même texte revient à chaque ligne\n";
+    }
+    LPTF::LPTF_Packet relayed;
+    std::string relayed_user;
+    std::string relayed_text;
+    uint64_t relayed_time = 0;
+    const bool sent = sessions && sender.send_packet(LPTF::ChatMessage::create("bob", long_chat, 42));
+    bool received = false;
+    while (sent && !received && receiver.receive_packet(relayed)) {
+        received = LPTF::ChatMessage::parse(relayed, relayed_user, relayed_text, relayed_time);
+    }
+    alarm(0);
+    const size_t negotiated_threshold = sender.get_compression_threshold();
+    sender.disconnect();
+    receiver.disconnect();
+    kill(server_pid, SIGKILL);
+    waitpid(server_pid, nullptr, 0);
+    
+    if (!sessions || negotiated_threshold != LPTF::Compression::DEFAULT_THRESHOLD ||
+        !sent || !received || relayed_user != "bob" || relayed_text != long_chat || relayed_time != 42) {
+        std::cout << "   ✗ Compression negotiation failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << long_chat.size() << " byte chat relayed between two compressed sessions" << std::endl;
+
+    // Test 14: File d'envoi (politiques de débordement, watermarks, voie des fragments)
+    // sur une socketpair au tampon réduit : le lecteur ne doit voir que des trames entières
+    std::cout << "\n14. Testing Write Queue Policies:" << std::endl;
+    const std::string queue_padding(1237, 'q');
+    std::vector<SharedBuffer> queue_frames;
+    for (uint64_t i = 0; i < 24; ++i) {
+        queue_frames.push_back(make_shared_buffer(
+            LPTF::ChatMessage::create("bob", "m" + std::to_string(i) + queue_padding, i).serialize()));
+    }
+    const size_t queue_frame_size = queue_frames[0]->size();
+    auto open_pair = [](LPTF_Socket& writer, int& reader_fd) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            return false;
+        }
+        const int small_buffer = 4096;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small_buffer, sizeof(small_buffer));
+        setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &small_buffer, sizeof(small_buffer));
+        writer.attach(fds[0]);
+        reader_fd = fds[1];
+        return writer.set_non_blocking(true);
+    };
+    
+    // DROP_OLDEST : la tête entamée est gardée entière, les suivantes non commencées tombent
+    LPTF_Socket drop_writer;
+    int drop_reader = -1;
+    WriteQueue drop_queue(8 * 1024, 2 * 1024, 64);
+    bool drop_ok = open_pair(drop_writer, drop_reader);
+    for (const SharedBuffer& frame : queue_frames) {
+        drop_ok = drop_ok && drop_queue.push(frame);
+    }
+    const ssize_t first_sent = drop_queue.flush(drop_writer);
+    const bool head_partial = first_sent > 0 && static_cast<size_t>(first_sent) % queue_frame_size != 0;
+    const bool was_above = drop_queue.is_above_high_watermark();
+    const size_t dropped_frames = drop_queue.drop_oldest(drop_queue.get_low_watermark(), 64 / 4);
+    LPTF::FrameReassembler drop_input;
+    std::vector<uint64_t> drop_numbers;
+    for (int round = 0; round < 1000 && drop_ok && !drop_queue.empty(); ++round) {
+        drop_ok = drop_queue.flush(drop_writer) >= 0 && read_available(drop_reader, drop_input);
+    }
+    drop_ok = drop_ok && drop_queue.empty() && read_available(drop_reader, drop_input) &&
+              collect_chats(drop_input, drop_numbers) && drop_input.buffered_size() == 0 &&
+              !drop_numbers.empty() && drop_numbers[0] == 0 && is_increasing(drop_numbers) &&
+              drop_numbers.size() + dropped_frames == queue_frames.size() && head_partial && was_above;
+    close(drop_reader);
+    
+    // DISCONNECT : la file est vidée d'un coup ; le lecteur n'a reçu qu'un préfixe du flux
+    LPTF_Socket cut_writer;
+    int cut_reader = -1;
+    WriteQueue cut_queue(8 * 1024, 2 * 1024, 64);
+    bool cut_ok = open_pair(cut_writer, cut_reader);
+    for (size_t i = 0; i < 8 && cut_ok; ++i) {
+        cut_ok = cut_queue.push(queue_frames[i]);
+    }
+    cut_ok = cut_ok && cut_queue.is_above_high_watermark() && cut_queue.flush(cut_writer) > 0;
+    cut_queue.clear();
+    cut_writer.close_socket();
+    LPTF::FrameReassembler cut_input;
+    std::vector<uint64_t> cut_numbers;
+    cut_ok = cut_ok && cut_queue.empty() && cut_queue.get_queued_bytes() == 0 &&
+             read_available(cut_reader, cut_input) && collect_chats(cut_input, cut_numbers) &&
+             (cut_numbers.empty() || (cut_numbers[0] == 0 && is_increasing(cut_numbers)));
+    close(cut_reader);
+    
+    // BLOCK : l'émetteur attend que le lecteur vide la file sous le low watermark ;
+    // sans lecteur, l'attente se termine au bout du délai
+    LPTF_Socket block_writer;
+    int block_reader = -1;
+    WriteQueue block_queue(8 * 1024, 2 * 1024, 64);
+    bool block_ok = open_pair(block_writer, block_reader);
+    for (size_t i = 0; i < 12 && block_ok; ++i) {
+        block_ok = block_queue.push(queue_frames[i]);
+    }
+    block_ok = block_ok && block_queue.is_above_high_watermark() && block_queue.flush(block_writer) > 0;
+    LPTF::FrameReassembler block_input;
+    std::atomic<bool> block_reading(true);
+    std::thread block_drainer([&] {
+        while (block_reading) {
+            read_available(block_reader, block_input);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (block_ok && !block_queue.is_below_low_watermark()) {
+        block_ok = block_writer.wait_writable(1000) && block_queue.flush(block_writer) >= 0;
+    }
+    while (block_ok && !block_queue.empty()) {
+        block_ok = block_writer.wait_writable(1000) && block_queue.flush(block_writer) >= 0;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    block_reading = false;
+    block_drainer.join();
+    read_available(block_reader, block_input);
+    std::vector<uint64_t> block_numbers;
+    block_ok = block_ok && collect_chats(block_input, block_numbers) && block_numbers.size() == 12 &&
+               block_numbers[0] == 0 && is_increasing(block_numbers);
+    for (size_t i = 12; i < 20 && block_ok; ++i) {
+        block_ok = block_queue.push(queue_frames[i]);
+    }
+    block_queue.flush(block_writer);
+    const auto wait_start = std::chrono::steady_clock::now();
+    const bool stalled = !block_writer.wait_writable(50);
+    const auto waited = std::chrono::steady_clock::now() - wait_start;
+    block_ok = block_ok && stalled && waited >= std::chrono::milliseconds(40);
+    close(block_reader);
+    
+    // Hystérésis : entre les deux seuils, ni au-dessus du haut ni sous le bas
+    WriteQueue band_queue(8 * 1024, 2 * 1024, 64);
+    for (size_t i = 0; i < 8; ++i) {
+        band_queue.push(queue_frames[i]);
+    }
+    const bool band_above = band_queue.is_above_high_watermark();
+    band_queue.drop_oldest(5 * 1024, 64);
+    const bool band_ok = band_above && !band_queue.is_above_high_watermark() &&
+                         !band_queue.is_below_low_watermark();
+    band_queue.set_watermarks(1000, 5000);
+    const bool clamp_ok = band_queue.get_low_watermark() == 1000;
+    
+    // Voie des fragments : le chat passe entre deux fragments, jamais au milieu d'un fragment
+    LPTF_Socket bulk_writer;
+    int bulk_reader = -1;
+    WriteQueue bulk_queue;
+    bool bulk_ok = open_pair(bulk_writer, bulk_reader);
+    const std::vector<uint8_t> bulk_frame = file_packet.serialize();
+    std::vector<uint8_t> bulk_fragments;
+    const size_t bulk_count = LPTF::Fragmentation::split_frame(bulk_frame.data(), bulk_frame.size(), 3,
+                                                                bulk_fragments);
+    bulk_ok = bulk_ok && bulk_queue.push_bulk(make_shared_buffer(std::move(bulk_fragments)));
+    LPTF::FrameReassembler bulk_input;
+    LPTF::FragmentReassembler bulk_rebuilt;
+    std::vector<uint8_t> bulk_message;
+    std::vector<char> bulk_order; // 'f' fragment, 'c' chat
+    size_t next_chat = 0;
+    for (int round = 0; round < 100000 && bulk_ok && (!bulk_queue.empty() || next_chat < 6); ++round) {
+        if (round % 3 == 0 && next_chat < 6) {
+            bulk_ok = bulk_queue.push(queue_frames[next_chat++]);
+        }
+        bulk_ok = bulk_ok && bulk_queue.flush(bulk_writer) >= 0 && read_available(bulk_reader, bulk_input);
+        const uint8_t* frame = nullptr;
+        size_t frame_size = 0;
+        while (bulk_ok && bulk_input.next_frame(frame, frame_size)) {
+            if (LPTF::Fragmentation::is_fragment(frame, frame_size)) {
+                LPTF::ByteSpan message;
+                const LPTF::FragmentStatus status = bulk_rebuilt.add(frame, frame_size, message);
+                if (status == LPTF::FragmentStatus::COMPLETE) {
+                    bulk_message.assign(message.data, message.data + message.size);
+                }
+                bulk_ok = status == LPTF::FragmentStatus::COMPLETE || status == LPTF::FragmentStatus::INCOMPLETE;
+                bulk_order.push_back('f');
+            } else {
+                bulk_ok = LPTF::LPTF_PacketView(frame, frame_size).is_valid();
+                bulk_order.push_back('c');
+            }
+        }
+    }
+    const auto first_chat = std::find(bulk_order.begin(), bulk_order.end(), 'c');
+    const auto last_fragment = std::find(bulk_order.rbegin(), bulk_order.rend(), 'f');
+    bulk_ok = bulk_ok && !bulk_input.is_corrupted() && bulk_message == bulk_frame &&
+              std::count(bulk_order.begin(), bulk_order.end(), 'c') == 6 &&
+              static_cast<size_t>(std::count(bulk_order.begin(), bulk_order.end(), 'f')) == bulk_count &&
+              first_chat != bulk_order.end() && last_fragment != bulk_order.rend() &&
+              first_chat < last_fragment.base() - 1;
+    close(bulk_reader);
+    
+    if (!drop_ok || !cut_ok || !block_ok || !band_ok || !clamp_ok || !bulk_ok) {
+        std::cout << "   ✗ Write queue policies failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << dropped_frames << " frames dropped behind a partial head, " << bulk_count
+              << " fragments interleaved with chat" << std::endl;
+
+    // Test 15: Roue de temporisation, pilotée comme par le Reactor : chaque attente
+    // dure next_timeout(), un timer sur chaque niveau et un au-delà de la portée
+    std::cout << "\n15. Testing Timer Wheel Cascade and Expiry:" << std::endl;
+    const uint64_t wheel_origin = 5000;
+    const uint64_t wheel_deadlines[] = {25, 700, 45000, 3000000, 200000000};
+    const size_t wheel_count = sizeof(wheel_deadlines) / sizeof(wheel_deadlines[0]);
+    TimerWheel wheel;
+    wheel.reset(wheel_origin);
+    for (size_t i = 0; i < wheel_count; ++i) {
+        wheel.schedule(wheel_origin + wheel_deadlines[i], i);
+    }
+    const TimerWheel::TimerId cancelled = wheel.schedule(wheel_origin + 45000, wheel_count);
+    wheel.cancel(cancelled);
+    
+    std::vector<uint64_t> fired_at(wheel_count + 1, 0);
+    std::vector<TimerWheel::Expired> wheel_expired;
+    uint64_t wheel_now = wheel_origin;
+    size_t wheel_waits = 0;
+    bool wheel_ok = wheel.size() == wheel_count;
+    while (wheel_ok && !wheel.empty() && wheel_waits < 100000) {
+        const int wait_ms = wheel.next_timeout(wheel_now, 60000);
+        wheel_ok = wait_ms >= 0 && wait_ms <= 60000;
+        wheel_now += static_cast<uint64_t>(wait_ms);
+        wheel_expired.clear();
+        wheel.advance(wheel_now, wheel_expired);
+        for (const TimerWheel::Expired& expired : wheel_expired) {
+            wheel_ok = wheel_ok && expired.user_data < wheel_count && fired_at[expired.user_data] == 0;
+            if (expired.user_data <= wheel_count) {
+                fired_at[expired.user_data] = wheel_now;
+            }
+        }
+        ++wheel_waits;
+    }
+    for (size_t i = 0; i < wheel_count; ++i) {
+        const uint64_t deadline = wheel_origin + wheel_deadlines[i];
+        wheel_ok = wheel_ok && fired_at[i] >= deadline && fired_at[i] < deadline + TimerWheel::TICK_MS;
+    }
+    wheel_ok = wheel_ok && fired_at[wheel_count] == 0 && wheel.empty();
+    
+    if (!wheel_ok) {
+        std::cout << "   ✗ Timer wheel failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << wheel_count << " timers fired on time across " << TimerWheel::LEVELS
+              << " levels in " << wheel_waits << " waits" << std::endl;
+
+    // Test 16: Historique borné en octets : éviction des plus anciennes, trame trop
+    // grosse numérotée mais pas conservée, rattrapage plafonné aux plus récentes
+    std::cout << "\n16. Testing Room History Budget:" << std::endl;
+    RoomHistory room_history(64, 4096, 1024);
+    std::vector<uint8_t> history_relay;
+    uint64_t appended_seq = 0;
+    for (uint64_t i = 1; i <= 60; ++i) {
+        const std::vector<uint8_t> chat =
+            LPTF::ChatMessage::create("bob", "message " + std::to_string(i) + std::string(100, '.'), i).serialize();
+        appended_seq = room_history.append(LPTF::LPTF_PacketView(chat.data(), chat.size()), history_relay);
+    }
+    const std::vector<uint8_t> oversized =
+        LPTF::ChatMessage::create("bob", std::string(2000, 'x'), 61).serialize();
+    history_relay.clear();
+    const uint64_t oversized_seq = room_history.append(LPTF::LPTF_PacketView(oversized.data(), oversized.size()), history_relay);
+    
+    // Séquences des trames d'un tampon de rattrapage
+    auto collected_seqs = [](const std::vector<uint8_t>& bytes) {
+        std::vector<uint64_t> seqs;
+        size_t offset = 0;
+        while (offset + LPTF::LPTF_PacketView::HEADER_SIZE <= bytes.size()) {
+            const size_t size = LPTF::LPTF_PacketView::HEADER_SIZE +
+                ((size_t(bytes[offset + 8]) << 24) | (size_t(bytes[offset + 9]) << 16) |
+                 (size_t(bytes[offset + 10]) << 8) | size_t(bytes[offset + 11]));
+            uint64_t seq = 0;
+            LPTF::LPTF_PacketView(bytes.data() + offset, size).get_uint64("seq", seq);
+            seqs.push_back(seq);
+            offset += size;
+        }
+        return seqs;
+    };
+    std::vector<uint8_t> catch_up;
+    const uint64_t history_last = room_history.collect_since(0, 1024 * 1024, catch_up);
+    const std::vector<uint64_t> kept = collected_seqs(catch_up);
+    std::vector<uint8_t> capped;
+    room_history.collect_since(0, 500, capped);
+    const std::vector<uint64_t> newest = collected_seqs(capped);
+    
+    const bool history_ok = appended_seq == 60 && oversized_seq == 61 && history_last == 61 &&
+                            !history_relay.empty() && room_history.get_stored_bytes() <= 4096 &&
+                            catch_up.size() == room_history.get_stored_bytes() &&
+                            !kept.empty() && kept.size() < 60 && kept.back() == 60 &&
+                            kept.back() - kept.front() + 1 == kept.size() &&
+                            capped.size() <= 500 && !newest.empty() && newest.back() == 60 &&
+                            newest.size() < kept.size();
+    if (!history_ok) {
+        std::cout << "   ✗ Room history budget failed" << std::endl;
+        return 1;
+    }
+    std::cout << "   ✓ " << kept.size() << " frames kept in " << room_history.get_stored_bytes()
+              << " bytes, " << newest.size() << " in a 500-byte catch-up" << std::endl;
+
     std::cout << "\n=== All Tests Completed Successfully! ===" << std::endl;
     return 0;
 }